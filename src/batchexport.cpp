@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/batchexport.h"
+
+#include <QMarginsF>
+#include <QPageSize>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QPixmap>
+
+#include "src/log.h"
+#include "src/pdfmaster.h"
+#include "src/preferences.h"
+#include "src/rendering/abstractrenderer.h"
+#include "src/rendering/pdfdocument.h"
+#include "src/rendering/renderpool.h"
+#ifdef USE_EXTERNAL_RENDERER
+#include "src/rendering/externalrenderer.h"
+#endif
+
+BatchExport::BatchExport(const PdfMaster *pdf, const QString &target,
+                         const qreal dpi, QObject *parent)
+    : QObject(parent),
+      document(pdf->getDocument()),
+      page_part(preferences()->default_page_part),
+      target(target),
+      format(target.endsWith(".pdf", Qt::CaseInsensitive) ? FlatPdf
+                                                          : PngFiles),
+      resolution(dpi / 72),
+      total(document ? document->numberOfPages() : 0)
+{
+  for (int page = 0; page < total; ++page) {
+    const QPicture picture = pdf->drawingsPicture({page, page_part});
+    if (!picture.isNull()) drawings.insert(page, picture);
+  }
+  debug_msg(DebugRendering, "batch export" << target << total
+                                           << "pages, with drawings:"
+                                           << drawings.size());
+}
+
+BatchExport::~BatchExport()
+{
+  cancelled = true;
+  RenderPool::instance().cancel(this);
+  if (pdf_painter && pdf_painter->isActive()) pdf_painter->end();
+}
+
+void BatchExport::start()
+{
+  if (total <= 0 || resolution <= 0) {
+    emit finished(false, false);
+    return;
+  }
+  emit progress(0, total);
+  for (int page = 0; page < total; ++page)
+    RenderPool::instance().submit(this, RenderPool::Export,
+                                  [this, page]() { exportPage(page); });
+}
+
+QString BatchExport::pngFileName(const int page) const
+{
+  QString base = target;
+  if (base.endsWith(".png", Qt::CaseInsensitive)) base.chop(4);
+  return base + "-" +
+         QString("%1").arg(page + 1, QString::number(total).length(), 10,
+                           QChar('0')) +
+         ".png";
+}
+
+QImage BatchExport::renderPage(const int page) const
+{
+  std::unique_ptr<AbstractRenderer> renderer;
+#ifdef USE_EXTERNAL_RENDERER
+  if (preferences()->renderer == Renderer::ExternalRenderer)
+    renderer = std::make_unique<ExternalRenderer>(
+        preferences()->rendering_command, preferences()->rendering_arguments,
+        document, page_part);
+  else
+#endif
+    renderer.reset(createRenderer(document, page_part));
+  if (!renderer || !renderer->isValid()) return QImage();
+  QImage image = renderer->renderPixmap(page, resolution).toImage();
+  const auto picture = drawings.constFind(page);
+  if (image.isNull() || picture == drawings.cend()) return image;
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.scale(resolution, resolution);
+  painter.drawPicture(0, 0, *picture);
+  painter.end();
+  return image;
+}
+
+void BatchExport::exportPage(const int page)
+{
+  QImage image;
+  if (!cancelled) image = renderPage(page);
+  if (format == PngFiles) {
+    const bool success = !image.isNull() && image.save(pngFileName(page));
+    if (!success && !cancelled)
+      qWarning() << "Failed to export page" << page << "to"
+                 << pngFileName(page);
+    mutex.lock();
+    pageDone(success);
+  } else {
+    mutex.lock();
+    pending.insert(page, image);
+    writePdfPages();
+  }
+  mutex.unlock();
+}
+
+void BatchExport::writePdfPages()
+{
+  // Only one thread writes to the PDF. Other threads only queue their pages.
+  if (writing) return;
+  writing = true;
+  while (pending.contains(next_pdf_page)) {
+    const QImage image = pending.take(next_pdf_page);
+    const int page = next_pdf_page++;
+    mutex.unlock();
+    const bool success =
+        !image.isNull() && !cancelled && writePdfPage(page, image);
+    mutex.lock();
+    pageDone(success);
+  }
+  writing = false;
+}
+
+bool BatchExport::writePdfPage(const int page, const QImage &image)
+{
+  QSizeF size = document->pageSize(page);
+  if (page_part == LeftHalf || page_part == RightHalf) size.rwidth() /= 2;
+  const QPageSize page_size(size, QPageSize::Point);
+  if (!pdf_writer) {
+    pdf_writer = std::make_unique<QPdfWriter>(target);
+    pdf_writer->setCreator("BeamerPresenter");
+    pdf_writer->setResolution(qRound(72 * resolution));
+    pdf_writer->setPageMargins(QMarginsF());
+    pdf_writer->setPageSize(page_size);
+    pdf_painter = std::make_unique<QPainter>();
+    if (!pdf_painter->begin(pdf_writer.get()))
+      qCritical() << tr("Could not write PDF file") << target;
+  } else if (pdf_painter->isActive()) {
+    pdf_writer->setPageSize(page_size);
+    pdf_writer->newPage();
+  }
+  if (!pdf_painter->isActive()) return false;
+  pdf_painter->drawImage(
+      QRectF(0, 0, pdf_writer->width(), pdf_writer->height()), image);
+  return true;
+}
+
+void BatchExport::pageDone(const bool success)
+{
+  ++done;
+  if (!success) ++failed;
+  emit progress(done, total);
+  if (done < total) return;
+  if (pdf_painter && pdf_painter->isActive()) pdf_painter->end();
+  pdf_painter.reset();
+  pdf_writer.reset();
+  debug_msg(DebugRendering,
+            "batch export finished" << target << "failed pages:" << failed);
+  emit finished(failed == 0 && !cancelled, cancelled);
+}
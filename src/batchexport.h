@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef BATCHEXPORT_H
+#define BATCHEXPORT_H
+
+#include <QImage>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QPicture>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+#include "src/config.h"
+#include "src/enumerates.h"
+
+class PdfDocument;
+class PdfMaster;
+class QPdfWriter;
+class QPainter;
+
+/**
+ * @brief Export all pages of a document including drawings to images or to
+ * a flattened PDF.
+ *
+ * The drawings are recorded in the main thread when the export is
+ * started. Pages are then rendered in parallel by the RenderPool, the
+ * drawings are painted on the rendered pages and the results are written
+ * directly to disk. PNG files are written by the thread rendering the page.
+ * PDF pages must be written in order: each thread finishing a page writes
+ * all pages which are ready.
+ *
+ * The main thread is never blocked. Progress is reported by signals.
+ */
+class BatchExport : public QObject
+{
+  Q_OBJECT
+
+ public:
+  /// Output format.
+  enum Format {
+    PngFiles,  ///< one PNG image per page
+    FlatPdf,   ///< PDF with one image per page
+  };
+
+ private:
+  /// Document of the exported pages.
+  std::shared_ptr<const PdfDocument> document;
+
+  /// Page part which is exported.
+  const PagePart page_part;
+
+  /// Target: PDF file, or file name pattern for PNG files.
+  const QString target;
+
+  /// Output format, derived from target.
+  const Format format;
+
+  /// Resolution in pixels per point.
+  const qreal resolution;
+
+  /// Total number of pages.
+  const int total;
+
+  /// Drawings for each page, recorded in the main thread.
+  QMap<int, QPicture> drawings;
+
+  /// Mutex for all following members.
+  QMutex mutex;
+
+  /// Rendered pages which are not written to the PDF yet.
+  QMap<int, QImage> pending;
+
+  /// Next page which must be written to the PDF.
+  int next_pdf_page = 0;
+
+  /// Some thread is currently writing to the PDF.
+  bool writing = false;
+
+  /// PDF writer, created when writing the first page.
+  std::unique_ptr<QPdfWriter> pdf_writer;
+
+  /// Painter on pdf_writer.
+  std::unique_ptr<QPainter> pdf_painter;
+
+  /// Number of finished pages.
+  int done = 0;
+
+  /// Number of pages which could not be exported.
+  int failed = 0;
+
+  /// Set when the export was cancelled.
+  std::atomic<bool> cancelled{false};
+
+  /// Render page, paint drawings and write result. Called in worker threads.
+  void exportPage(const int page);
+
+  /// Render page to image including drawings. Called in worker threads.
+  QImage renderPage(const int page) const;
+
+  /// File name of PNG image for given page.
+  QString pngFileName(const int page) const;
+
+  /// Append page to the PDF. Only called by the thread writing the PDF.
+  bool writePdfPage(const int page, const QImage &image);
+
+  /// Write all pending pages which are ready to the PDF. mutex must be
+  /// locked, but is unlocked while writing.
+  void writePdfPages();
+
+  /// Count a finished page and report progress. mutex must be locked.
+  void pageDone(const bool success);
+
+ public:
+  /// Constructor: record the drawings of all pages of pdf. Pages are exported
+  /// with given resolution in dpi.
+  BatchExport(const PdfMaster *pdf, const QString &target, const qreal dpi,
+              QObject *parent = nullptr);
+
+  /// Destructor: cancel and wait for running jobs.
+  ~BatchExport();
+
+  /// Number of exported pages.
+  int pages() const noexcept { return total; }
+
+
+ public slots:
+  /// Start the export.
+  void start();
+
+  /// Stop the export as soon as possible.
+  void cancel() noexcept { cancelled = true; }
+
+ signals:
+  /// Number of finished pages out of total pages.
+  void progress(const int done, const int total);
+
+  /// Export finished. success is false if some pages could not be exported
+  /// or the export was cancelled. was_cancelled is true if the export was
+  /// cancelled using cancel().
+  void finished(const bool success, const bool was_cancelled);
+};
+
+#endif  // BATCHEXPORT_H
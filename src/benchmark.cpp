@@ -0,0 +1,328 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+// Headless benchmark of the PDF engines. This renders a PDF document with
+// every compiled-in engine without creating a GUI and prints the results
+// as JSON to standard output.
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPixmap>
+#include <QtDebug>
+#include <algorithm>
+#include <memory>
+
+#include "src/config.h"
+#include "src/names.h"
+#include "src/preferences.h"
+#include "src/rendering/abstractrenderer.h"
+#include "src/rendering/pdfdocument.h"
+#include "src/rendering/pngpixmap.h"
+#include "src/rendering/renderstats.h"
+#ifdef USE_MUPDF
+#include "src/rendering/mupdfdocument.h"
+#endif
+#ifdef USE_POPPLER
+#include "src/rendering/popplerdocument.h"
+#endif
+#ifdef USE_QTPDF
+#include "src/rendering/qtdocument.h"
+#endif
+#ifdef USE_EXTERNAL_RENDERER
+#include "src/rendering/externalrenderer.h"
+#endif
+
+namespace
+{
+/// Options of a benchmark run.
+struct BenchOptions {
+  /// Width of rendered pages in pixels.
+  int width = 1920;
+  /// Maximum number of pages, 0 for all pages.
+  int pages = 0;
+  /// Number of times each page is rendered.
+  int repeat = 1;
+};
+
+/// Engine which can be tested.
+struct BenchEngine {
+  /// Name used on the command line and in the output.
+  const char *name;
+  /// Engine for loading the document.
+  PdfEngine engine;
+  /// Renderer. The external renderer uses the engine from the preferences.
+  Renderer renderer;
+};
+
+/// Elapsed time in ms with sub-millisecond precision.
+float elapsed_ms(const QElapsedTimer &timer)
+{
+  return timer.nsecsElapsed() / 1e6f;
+}
+
+/// Load document with given engine. Return nullptr if loading failed.
+std::shared_ptr<PdfDocument> load_document(const PdfEngine engine,
+                                           const QString &filename)
+{
+  std::shared_ptr<PdfDocument> doc;
+  switch (engine) {
+#ifdef USE_MUPDF
+    case PdfEngine::MuPdf:
+      doc = std::make_shared<MuPdfDocument>(filename);
+      break;
+#endif
+#ifdef USE_POPPLER
+    case PdfEngine::Poppler:
+      doc = std::make_shared<PopplerDocument>(filename);
+      break;
+#endif
+#ifdef USE_QTPDF
+    case PdfEngine::QtPDF:
+      doc = std::make_shared<QtDocument>(filename);
+      break;
+#endif
+  }
+  if (doc && doc->isValid()) return doc;
+  return nullptr;
+}
+
+/// Measure rendering of all pages of doc with renderer and compression of
+/// the rendered pages with all cache codecs.
+QJsonObject run_benchmark(const std::shared_ptr<PdfDocument> &doc,
+                          const AbstractRenderer *renderer,
+                          const BenchOptions &options)
+{
+  QElapsedTimer timer;
+  DurationHistogram render, display_list;
+  QMap<QString, DurationHistogram> encode, decode;
+  QMap<QString, qint64> compressed_bytes;
+  qint64 raw_bytes = 0;
+  QJsonArray pages;
+  int npages = doc->numberOfPages();
+  if (options.pages > 0 && options.pages < npages) npages = options.pages;
+  for (int page = 0; page < npages; ++page) {
+    const QSizeF size = doc->pageSize(page);
+    if (size.isEmpty()) continue;
+    const qreal resolution = options.width / size.width();
+    QJsonObject page_obj{{"page", page}};
+#ifdef USE_MUPDF
+    // MuPDF creates a display list before rendering a page for the first
+    // time. Build it explicitly to measure it separately.
+    if (doc->type() == PdfEngine::MuPdf) {
+      const auto mudoc = static_cast<const MuPdfDocument *>(doc.get());
+      fz_context *ctx = nullptr;
+      fz_display_list *list = nullptr;
+      fz_rect bbox;
+      timer.start();
+      mudoc->prepareRendering(&ctx, &bbox, &list, page, resolution);
+      const float ms = elapsed_ms(timer);
+      // ctx is the context of the document and must not be dropped here.
+      if (ctx && list) fz_drop_display_list(ctx, list);
+      display_list.add(ms);
+      page_obj.insert("display list ms", ms);
+    }
+#endif
+    QImage image;
+    float total = 0.f;
+    for (int i = 0; i < options.repeat; ++i) {
+      timer.start();
+      const QPixmap pixmap = renderer->renderPixmap(page, resolution);
+      const float ms = elapsed_ms(timer);
+      render.add(ms);
+      total += ms;
+      if (image.isNull()) image = pixmap.toImage();
+    }
+    page_obj.insert("render ms", total / options.repeat);
+    if (image.isNull()) {
+      page_obj.insert("error", "rendering failed");
+      pages.append(page_obj);
+      continue;
+    }
+    raw_bytes += image.sizeInBytes();
+
+    const auto &codecs = get_string_to_cache_codec();
+    for (auto it = codecs.cbegin(); it != codecs.cend(); ++it) {
+      const PngPixmap png(image, page, resolution, *it);
+      if (png.isNull()) continue;
+      encode[it.key()].add(png.getCompressTime());
+      compressed_bytes[it.key()] += png.size();
+      timer.start();
+      const QPixmap decoded = png.pixmap();
+      decode[it.key()].add(elapsed_ms(timer));
+    }
+    pages.append(page_obj);
+  }
+
+  // Throughput of the cache in MB of uncompressed pixel data per second.
+  const auto throughput = [raw_bytes](const DurationHistogram &hist) {
+    const double total_ms = hist.mean() * hist.count();
+    return total_ms > 0 ? raw_bytes / (1e3 * total_ms) : 0.;
+  };
+  QJsonObject codec_obj;
+  for (auto it = encode.cbegin(); it != encode.cend(); ++it) {
+    const DurationHistogram &dec = decode[it.key()];
+    const qint64 bytes = compressed_bytes[it.key()];
+    codec_obj.insert(
+        it.key(),
+        QJsonObject{
+            {"encode ms", it->toJson()},
+            {"decode ms", dec.toJson()},
+            {"bytes", bytes},
+            {"ratio", raw_bytes > 0 ? double(bytes) / raw_bytes : 0.},
+            {"encode MB/s", throughput(*it)},
+            {"decode MB/s", throughput(dec)},
+        });
+  }
+  QJsonObject result{
+      {"pages", pages},
+      {"render ms", render.toJson()},
+      {"raw bytes", raw_bytes},
+      {"codecs", codec_obj},
+  };
+  if (display_list.count() > 0)
+    result.insert("display list ms", display_list.toJson());
+  return result;
+}
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+  // Rendering does not require a display.
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  QApplication app(argc, argv);
+  app.setApplicationName("BeamerPresenter");
+  app.setApplicationVersion(APP_VERSION);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Measure rendering and cache performance of all PDF engines");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  parser.addPositionalArgument("<file.pdf>", "PDF document");
+  parser.addOption(
+      {{"c", "config"}, "settings / configuration file", "file"});
+  parser.addOption({{"w", "width"}, "width of rendered pages in pixels",
+                    "pixels", "1920"});
+  parser.addOption({{"n", "pages"},
+                    "only render the given number of pages",
+                    "number"});
+  parser.addOption(
+      {{"r", "repeat"}, "render each page multiple times", "number", "1"});
+  parser.addOption({{"e", "engines"},
+                    "comma-separated list of engines: mupdf, poppler, qtpdf, "
+                    "external (default: all)",
+                    "names"});
+  parser.addOption({{"o", "output"}, "write results to file", "file"});
+  parser.process(app);
+  if (parser.positionalArguments().length() != 1) parser.showHelp(1);
+  const QString filename = parser.positionalArguments().first();
+
+  if (parser.isSet("c"))
+    GlobalPreferences::initialize(parser.value("c"));
+  else
+    GlobalPreferences::initialize();
+  GlobalPreferences::writable()->loadSettings();
+
+  BenchOptions options;
+  options.width = std::max(parser.value("width").toInt(), 1);
+  options.pages = std::max(parser.value("pages").toInt(), 0);
+  options.repeat = std::max(parser.value("repeat").toInt(), 1);
+  const QList<BenchEngine> available = {
+#ifdef USE_MUPDF
+      {"mupdf", PdfEngine::MuPdf, Renderer::MuPDF},
+#endif
+#ifdef USE_POPPLER
+      {"poppler", PdfEngine::Poppler, Renderer::Poppler},
+#endif
+#ifdef USE_QTPDF
+      {"qtpdf", PdfEngine::QtPDF, Renderer::QtPDF},
+#endif
+#ifdef USE_EXTERNAL_RENDERER
+      {"external", preferences()->pdf_engine, Renderer::ExternalRenderer},
+#endif
+  };
+  QStringList engines;
+  if (parser.isSet("engines"))
+    engines = parser.value("engines").toLower().split(',');
+  else
+    for (const auto &entry : available) engines.append(entry.name);
+
+  QJsonArray results;
+  for (const auto &name : std::as_const(engines)) {
+    const auto entry =
+        std::find_if(available.cbegin(), available.cend(),
+                     [&name](const BenchEngine &e) { return name == e.name; });
+    if (entry == available.cend()) {
+      qWarning() << "Skipping unknown or unavailable engine:" << name;
+      continue;
+    }
+    const PdfEngine engine = entry->engine;
+    const Renderer renderer_type = entry->renderer;
+#ifdef USE_EXTERNAL_RENDERER
+    if (renderer_type == Renderer::ExternalRenderer &&
+        preferences()->rendering_command.isEmpty()) {
+      qWarning() << "Skipping external renderer: no rendering command "
+                    "defined in configuration";
+      continue;
+    }
+#endif
+
+    QElapsedTimer timer;
+    timer.start();
+    const auto doc = load_document(engine, filename);
+    const float load_ms = elapsed_ms(timer);
+    if (!doc) {
+      qCritical() << "Loading document failed with engine" << name;
+      continue;
+    }
+    std::unique_ptr<AbstractRenderer> renderer;
+#ifdef USE_EXTERNAL_RENDERER
+    if (renderer_type == Renderer::ExternalRenderer)
+      renderer = std::make_unique<ExternalRenderer>(
+          preferences()->rendering_command, preferences()->rendering_arguments,
+          doc);
+    else
+#endif
+      renderer.reset(createRenderer(doc));
+    if (!renderer || !renderer->isValid()) {
+      qCritical() << "Creating renderer failed for engine" << name;
+      continue;
+    }
+    QJsonObject result = run_benchmark(doc, renderer.get(), options);
+    result.insert("engine", name);
+    result.insert("renderer", renderer_name(renderer_type));
+    result.insert("load ms", load_ms);
+    results.append(result);
+  }
+
+  const QJsonObject output{
+      {"file", QFileInfo(filename).absoluteFilePath()},
+      {"version", APP_VERSION},
+      {"width", options.width},
+      {"repeat", options.repeat},
+      {"engines", results},
+  };
+  const QByteArray json = QJsonDocument(output).toJson();
+  if (parser.isSet("output")) {
+    QFile file(parser.value("output"));
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) < 0) {
+      qCritical() << "Could not write results to" << file.fileName();
+      delete preferences();
+      return 1;
+    }
+  } else {
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    out.write(json);
+  }
+  delete preferences();
+  return results.isEmpty() ? 1 : 0;
+}
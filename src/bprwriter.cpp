@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/bprwriter.h"
+
+#include <QElapsedTimer>
+#include <QSaveFile>
+
+#include "src/gzipdevice.h"
+#include "src/log.h"
+#include "src/rendering/renderpool.h"
+
+BprWriter::BprWriter(const QString &filename, QObject *parent)
+    : QObject(parent),
+      filename(filename),
+      compress(!filename.endsWith(".xml")),
+      head_buffer(&head),
+      writer(std::make_unique<QXmlStreamWriter>())
+{
+  head_buffer.open(QBuffer::WriteOnly);
+  writer->setDevice(&head_buffer);
+}
+
+BprWriter::~BprWriter()
+{
+  // Never drop a save.
+  finish();
+}
+
+void BprWriter::start()
+{
+  RenderPool::instance().submit(this, RenderPool::Saving, [this]() {
+    success = write();
+    emit finished(success);
+  });
+}
+
+bool BprWriter::finish()
+{
+  // Write the file now if the job is still queued.
+  if (RenderPool::instance().remove(this) > 0) success = write();
+  RenderPool::instance().cancel(this);
+  return success;
+}
+
+bool BprWriter::write()
+{
+  QElapsedTimer timer;
+  timer.start();
+  QSaveFile file(filename);
+  if (!file.open(QFile::WriteOnly)) {
+    qWarning() << "Could not open file for writing:" << filename;
+    return false;
+  }
+  QIODevice *device = &file;
+  std::unique_ptr<GzipDevice> gzip;
+  if (compress) {
+    gzip = std::make_unique<GzipDevice>(&file);
+    if (gzip->open(QIODevice::WriteOnly))
+      device = gzip.get();
+    else
+      qWarning() << "Compressing document failed. Saving uncompressed XML to"
+                 << filename;
+  }
+
+  // Continue the document started in the main thread.
+  head_buffer.close();
+  device->write(head);
+  writer->setDevice(device);
+  PdfMaster::writePages(*writer, pages);
+  writer->writeEndElement();  // "xournal" element
+  writer->writeEndDocument();
+  writer->setDevice(nullptr);
+  if (gzip) gzip->close();
+
+  if (writer->hasError() || (gzip && gzip->hasError())) {
+    qWarning() << "Writing document failed:" << filename;
+    file.cancelWriting();
+    return false;
+  }
+  if (!file.commit()) {
+    qWarning() << "Saving document failed:" << filename << file.errorString();
+    return false;
+  }
+  if (device == &file)
+    qInfo() << "Saved uncompressed XML to" << filename;
+  else
+    qInfo() << "Saved gzip-compressed XML to" << filename;
+  debug_msg(DebugDrawing, "saving took" << timer.elapsed() << "ms");
+  return true;
+}
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef BPRWRITER_H
+#define BPRWRITER_H
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QXmlStreamWriter>
+#include <atomic>
+#include <memory>
+
+#include "src/config.h"
+#include "src/pdfmaster.h"
+
+/**
+ * @brief Write drawings and notes to a bpr/xopp/xml file in the background.
+ *
+ * The main thread writes the beginning of the document (preview, notes,
+ * ...) using xml() and adds snapshots of the drawings using addPages().
+ * These steps are cheap. start() then serializes the drawings in the
+ * RenderPool. Gzip compressed output is streamed to a temporary file, which
+ * atomically replaces the target file when everything was written
+ * successfully.
+ *
+ * A save which has not finished yet is completed when this object is
+ * deleted. Use finish() to obtain the result of such a save, since the
+ * signal finished() is not delivered after deleting this.
+ */
+class BprWriter : public QObject
+{
+  Q_OBJECT
+
+  /// Target file name.
+  const QString filename;
+
+  /// Compress output, false for files ending with ".xml".
+  const bool compress;
+
+  /// Beginning of the document written in the main thread.
+  QByteArray head;
+
+  /// Buffer on head.
+  QBuffer head_buffer;
+
+  /// XML writer, first writing to head_buffer and then to the file.
+  std::unique_ptr<QXmlStreamWriter> writer;
+
+  /// Snapshots of all pages of all documents.
+  QList<PdfMaster::PageSnapshot> pages;
+
+  /// Result of write(), valid after writing has finished.
+  std::atomic<bool> success{false};
+
+  /// Write the file. Return true on success. Called in a worker thread.
+  bool write();
+
+ public:
+  /// Constructor: prepare writing to filename.
+  explicit BprWriter(const QString &filename, QObject *parent = nullptr);
+
+  /// Destructor: write the file now if this has not happened yet.
+  ~BprWriter();
+
+  /// Target file name.
+  const QString &getFilename() const noexcept { return filename; }
+
+  /// XML writer for the beginning of the document. This must only be used
+  /// before calling start().
+  QXmlStreamWriter &xml() noexcept { return *writer; }
+
+  /// Add snapshots of pages. This must only be used before calling start().
+  void addPages(const QList<PdfMaster::PageSnapshot> &snapshots)
+  {
+    pages.append(snapshots);
+  }
+
+  /// Start writing in the background.
+  void start();
+
+  /// Complete the save now: write the file if the job is still queued or
+  /// wait until it has finished. Return true if the file was written.
+  bool finish();
+
+ signals:
+  /// Writing finished.
+  void finished(const bool success);
+};
+
+#endif  // BPRWRITER_H
@@ -7,11 +7,17 @@
 #include "src/preferences.h"
 
 const QString AbstractGraphicsPath::stringCoordinates() const noexcept
+{
+  return coordinatesToString(coordinates, sceneTransform());
+}
+
+QString AbstractGraphicsPath::coordinatesToString(
+    const QVector<QPointF> &coordinates, const QTransform &transform)
 {
   QString str;
   QPointF scene_point;
   for (const auto &point : coordinates) {
-    scene_point = mapToScene(point);
+    scene_point = transform.map(point);
     str += QString::number(scene_point.x());
     str += ' ';
     str += QString::number(scene_point.y());
@@ -11,6 +11,7 @@
 #include <QPointF>
 #include <QRectF>
 #include <QString>
+#include <QTransform>
 #include <QVector>
 
 #include "src/config.h"
@@ -86,6 +87,12 @@ class AbstractGraphicsPath : public QGraphicsItem
   /// @return number of nodes of the path
   int size() const noexcept { return coordinates.size(); }
 
+  /// @return coordinates of all nodes in item coordinates
+  const QVector<QPointF> &getCoordinates() const noexcept
+  {
+    return coordinates;
+  }
+
   /// Coordinate of the first node in the path.
   /// @return first point coordinate
   const QPointF firstPoint() const noexcept
@@ -134,6 +141,14 @@ class AbstractGraphicsPath : public QGraphicsItem
   /// @return list of coordinates formatted as string
   virtual const QString stringCoordinates() const noexcept;
 
+  /// Write coordinates mapped by transform to string for saving. This does
+  /// not access any graphics item and can be used in any thread.
+  /// @param coordinates nodes in item coordinates
+  /// @param transform scene transform of the item
+  /// @return list of coordinates formatted as string
+  static QString coordinatesToString(const QVector<QPointF> &coordinates,
+                                     const QTransform &transform);
+
   /// Write nodes coordinates to string for writing to SVG using
   /// item coordinates.
   /// @return list of coordinates formatted as string
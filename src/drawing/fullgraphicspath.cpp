@@ -238,7 +238,7 @@ void FullGraphicsPath::changeTool(const DrawTool &newtool) noexcept
   if (shape_cache.isEmpty()) shape_cache = shape();
 }
 
-const QString FullGraphicsPath::stringWidth() const noexcept
+QString FullGraphicsPath::pressuresToString(const QVector<float> &pressures)
 {
   QString str;
   for (const auto pr : pressures) {
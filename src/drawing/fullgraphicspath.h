@@ -104,7 +104,17 @@ class FullGraphicsPath : public AbstractGraphicsPath
 
   /// Write stroke widths to string for saving.
   /// @return space separated list of widths of the lines
-  const QString stringWidth() const noexcept override;
+  const QString stringWidth() const noexcept override
+  {
+    return pressuresToString(pressures);
+  }
+
+  /// @return pressures of all nodes
+  const QVector<float> &getPressures() const noexcept { return pressures; }
+
+  /// Write pressures to string for saving. This can be used in any thread.
+  /// @return list of widths formatted as string
+  static QString pressuresToString(const QVector<float> &pressures);
 };
 
 #endif  // FULLGRAPHICSPATH_H
@@ -523,59 +523,65 @@ PathContainer *PathContainer::copy() const noexcept
   return container;
 }
 
-void PathContainer::writeXml(QXmlStreamWriter &writer) const
+QList<PathContainer::ElementSnapshot> PathContainer::snapshot() const
 {
   std::multiset<QGraphicsItem *, decltype(&cmp_by_z)> itemlist{&cmp_by_z};
   for (const auto &[item, lookup] : _ref_count)
     if (lookup.visible) itemlist.insert(item);
+  QList<ElementSnapshot> elements;
   for (const auto item : itemlist) {
     switch (item->type()) {
       case TextGraphicsItem::Type: {
         const auto text = static_cast<TextGraphicsItem *>(item);
-        writer.writeStartElement("text");
-        writer.writeAttribute("font", QFontInfo(text->font()).family());
-        writer.writeAttribute("size",
-                              QString::number(text->font().pointSizeF()));
-        writer.writeAttribute(
-            "color", color_to_rgba(text->defaultTextColor()).toLower());
-        writer.writeAttribute("x", QString::number(text->x()));
-        writer.writeAttribute("y", QString::number(text->y()));
+        ElementSnapshot element{"text"};
+        QXmlStreamAttributes &attributes = element.attributes;
+        attributes.append("font", QFontInfo(text->font()).family());
+        attributes.append("size", QString::number(text->font().pointSizeF()));
+        attributes.append("color",
+                          color_to_rgba(text->defaultTextColor()).toLower());
+        attributes.append("x", QString::number(text->x()));
+        attributes.append("y", QString::number(text->y()));
         const QTransform transform = text->transform();
         if (!transform.isIdentity())
-          writer.writeAttribute("transform",
-                                QString("matrix(%1,%2,%3,%4,%5,%6)")
-                                    .arg(transform.m11())
-                                    .arg(transform.m12())
-                                    .arg(transform.m21())
-                                    .arg(transform.m22())
-                                    .arg(transform.dx())
-                                    .arg(transform.dy()));
-        writer.writeCharacters(text->toPlainText());
-        writer.writeEndElement();
+          attributes.append("transform",
+                            QString("matrix(%1,%2,%3,%4,%5,%6)")
+                                .arg(transform.m11())
+                                .arg(transform.m12())
+                                .arg(transform.m21())
+                                .arg(transform.m22())
+                                .arg(transform.dx())
+                                .arg(transform.dy()));
+        element.text = text->toPlainText();
+        elements.append(element);
         break;
       }
       case FullGraphicsPath::Type:
       case BasicGraphicsPath::Type: {
         const auto path = static_cast<AbstractGraphicsPath *>(item);
         const DrawTool &tool = path->getTool();
-        writer.writeStartElement("stroke");
+        ElementSnapshot element{"stroke"};
+        QXmlStreamAttributes &attributes = element.attributes;
         switch (tool.tool()) {
           case Tool::Pen:
           case Tool::FixedWidthPen:
-            writer.writeAttribute("tool", "pen");
+            attributes.append("tool", "pen");
             break;
           case Tool::Highlighter:
-            writer.writeAttribute("tool", "highlighter");
+            attributes.append("tool", "highlighter");
             break;
           default:
             break;
         }
-        writer.writeAttribute("color", color_to_rgba(tool.color()).toLower());
-        writer.writeAttribute("width", path->stringWidth());
+        attributes.append("color", color_to_rgba(tool.color()).toLower());
+        if (item->type() == FullGraphicsPath::Type)
+          // The widths are formatted when writing the snapshot.
+          element.pressures =
+              static_cast<FullGraphicsPath *>(item)->getPressures();
+        else
+          attributes.append("width", path->stringWidth());
         if (tool.pen().style() != Qt::SolidLine)
-          writer.writeAttribute(
-              "style", get_pen_style_codes().value(tool.pen().style()).c_str(),
-              "solid");
+          attributes.append(
+              "style", get_pen_style_codes().value(tool.pen().style()).c_str());
         if (tool.brush().style() != Qt::NoBrush) {
           // Compare brush and stroke color.
           const QColor &fill = tool.brush().color(),
@@ -586,31 +592,51 @@ void PathContainer::writeXml(QXmlStreamWriter &writer) const
             // Save only alpha relative to stroke color (as 8 bit int).
             // avoid division by zero by tiny offset
             float alpha = fill.alphaF() / (tool.pen().color().alphaF() + 1e-6);
-            writer.writeAttribute(
+            attributes.append(
                 "fill",
                 alpha >= 1 ? "255" : QString::number((int)(alpha * 255 + 0.5)));
           } else {
             // Write color to "brushcolor" attribute, which will be ignored by
             // Xournal++
-            writer.writeAttribute("brushcolor", color_to_rgba(fill).toLower());
+            attributes.append("brushcolor", color_to_rgba(fill).toLower());
           }
           if (tool.brush().style() != Qt::SolidPattern)
-            writer.writeAttribute("brushstyle",
-                                  get_brush_style_codes()
-                                      .value(tool.brush().style(), "unknown")
-                                      .c_str());
+            attributes.append("brushstyle",
+                              get_brush_style_codes()
+                                  .value(tool.brush().style(), "unknown")
+                                  .c_str());
         }
         if (tool.compositionMode() != QPainter::CompositionMode_SourceOver)
-          writer.writeAttribute("composition",
-                                get_composition_mode_codes()
-                                    .value(tool.compositionMode(), "unknown")
-                                    .c_str());
-        writer.writeCharacters(path->stringCoordinates());
-        writer.writeEndElement();
+          attributes.append("composition",
+                            get_composition_mode_codes()
+                                .value(tool.compositionMode(), "unknown")
+                                .c_str());
+        element.coordinates = path->getCoordinates();
+        element.transform = path->sceneTransform();
+        elements.append(element);
         break;
       }
     }
   }
+  return elements;
+}
+
+void PathContainer::writeXml(QXmlStreamWriter &writer,
+                             const QList<ElementSnapshot> &elements)
+{
+  for (const auto &element : elements) {
+    writer.writeStartElement(element.name);
+    writer.writeAttributes(element.attributes);
+    if (!element.pressures.isEmpty())
+      writer.writeAttribute(
+          "width", FullGraphicsPath::pressuresToString(element.pressures));
+    if (element.name == "stroke")
+      writer.writeCharacters(AbstractGraphicsPath::coordinatesToString(
+          element.coordinates, element.transform));
+    else
+      writer.writeCharacters(element.text);
+    writer.writeEndElement();
+  }
 }
 
 AbstractGraphicsPath *loadPath(QXmlStreamReader &reader)
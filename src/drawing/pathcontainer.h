@@ -18,6 +18,8 @@
 #include <QPointF>
 #include <QString>
 #include <QTransform>
+#include <QVector>
+#include <QXmlStreamAttributes>
 #include <map>
 #include <set>
 #include <unordered_map>
@@ -373,9 +375,44 @@ class PathContainer : public QObject
   /// @return true if inHistory == -2
   bool isPlainCopy() const noexcept { return inHistory == -2; }
 
+  /**
+   * @brief Copy of a drawing element for writing it to XML.
+   *
+   * Everything which requires access to graphics items is done when
+   * creating the snapshot. Coordinates and pressures are implicitly shared
+   * with the paths, such that creating a snapshot is cheap. Formatting the
+   * coordinates, which is expensive for large drawings, is done when writing
+   * the snapshot, which is possible in any thread.
+   */
+  struct ElementSnapshot {
+    /// XML element name, "stroke" or "text".
+    QString name;
+    /// XML attributes, except for the width of strokes with pressure.
+    QXmlStreamAttributes attributes;
+    /// Text of text elements.
+    QString text;
+    /// Nodes of strokes in item coordinates.
+    QVector<QPointF> coordinates;
+    /// Scene transform of strokes.
+    QTransform transform;
+    /// Pressures of strokes with variable width.
+    QVector<float> pressures;
+  };
+
+  /// Create a snapshot of all visible elements, sorted by z value.
+  QList<ElementSnapshot> snapshot() const;
+
+  /// Save elements of a snapshot in xml format. This can be used in any
+  /// thread.
+  static void writeXml(QXmlStreamWriter &writer,
+                       const QList<ElementSnapshot> &elements);
+
   /// Save drawings in xml format.
   /// @see loadDrawings(QXmlStreamReader &reader)
-  void writeXml(QXmlStreamWriter &writer) const;
+  void writeXml(QXmlStreamWriter &writer) const
+  {
+    writeXml(writer, snapshot());
+  }
 
   /// Load drawings for one specific page.
   /// @see writeXml(QXmlStreamWriter &writer) const
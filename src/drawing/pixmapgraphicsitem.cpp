@@ -13,6 +13,7 @@
 #include <utility>
 
 #include "src/log.h"
+#include "src/preferences.h"
 
 constexpr int RANDOM_INT = 42;
 
@@ -56,6 +57,15 @@ void PixmapGraphicsItem::paint(QPainter *painter,
   if (pixmaps.isEmpty()) return;
   const QRectF target_rect = painter->transform().mapRect(bounding_rect);
   const int ref_width = target_rect.width();
+  // Tiles are only shown if no animation is running.
+  const qreal scale = target_rect.width() / bounding_rect.width();
+  bool use_tiles = false;
+  if (mask_type == NoMask)
+    for (const auto &tile : std::as_const(tiles))
+      if (matchesScale(tile.resolution, scale)) {
+        use_tiles = true;
+        break;
+      }
   QPixmap pixmap;
   for (const auto &pix : std::as_const(pixmaps)) {
     if (pix.width() >= ref_width) {
@@ -65,7 +75,8 @@ void PixmapGraphicsItem::paint(QPainter *painter,
   }
   if (pixmap.isNull()) {
     pixmap = pixmaps.last();
-    qWarning() << "Showing pixmap with insufficient resolution";
+    if (!use_tiles && pixmap.width() != preview_width)
+      qWarning() << "Showing pixmap with insufficient resolution";
   }
   if (mask_type && !_mask.isNull()) {
     switch (mask_type) {
@@ -129,6 +140,14 @@ void PixmapGraphicsItem::paint(QPainter *painter,
     debug_msg(DebugRendering, "painting pixmap not pixel-aligned" << this);
     painter->drawPixmap(target_rect.toRect(), pixmap);
   }
+  if (use_tiles) {
+    // Draw sharp tiles on top of the scaled pixmap.
+    for (const auto &tile : std::as_const(tiles))
+      if (matchesScale(tile.resolution, scale))
+        painter->drawPixmap(
+            target_rect.topLeft() + QPointF(tile.index * tile_size),
+            tile.pixmap);
+  }
 #ifdef QT_DEBUG
   if ((preferences()->debug_level & (DebugRendering | DebugVerbose)) ==
       (DebugRendering | DebugVerbose)) {
@@ -153,6 +172,39 @@ void PixmapGraphicsItem::addPixmap(const QPixmap &pixmap) noexcept
   else
     pixmaps.insert(it, pixmap);
   newHashs.insert(pixmap.width());
+  if (preview_width > 0 && pixmap.width() >= preview_width) {
+    // The preview is no longer needed.
+    if (pixmap.width() != preview_width) {
+      for (auto it = pixmaps.begin(); it != pixmaps.end(); ++it) {
+        if (it->width() == preview_width) {
+          pixmaps.erase(it);
+          break;
+        }
+      }
+    }
+    preview_width = 0;
+  }
+  update();
+}
+
+void PixmapGraphicsItem::addPreview(const QPixmap &pixmap) noexcept
+{
+  if (pixmap.isNull()) return;
+  for (const auto &pix : std::as_const(pixmaps))
+    if (newHashs.contains(pix.width()) && pix.width() >= pixmap.width())
+      return;
+  // Remove pixmaps which are outdated and would be shown instead of the
+  // preview.
+  for (auto it = pixmaps.begin(); it != pixmaps.end();) {
+    if (newHashs.contains(it->width()))
+      ++it;
+    else
+      it = pixmaps.erase(it);
+  }
+  auto it = pixmaps.begin();
+  while (it != pixmaps.end() && it->width() < pixmap.width()) ++it;
+  pixmaps.insert(it, pixmap);
+  preview_width = pixmap.width();
   update();
 }
 
@@ -167,6 +219,7 @@ void PixmapGraphicsItem::clearOld() noexcept
     else
       it = pixmaps.erase(it);
   }
+  if (!newHashs.contains(preview_width)) preview_width = 0;
   newHashs.clear();
 }
 
@@ -211,6 +264,28 @@ bool PixmapGraphicsItem::hasWidth(const qreal width) const noexcept
   return false;
 }
 
+bool PixmapGraphicsItem::hasTile(const qreal resolution,
+                                 const QPoint index) const noexcept
+{
+  for (const auto &tile : tiles)
+    if (tile.index == index && matchesScale(tile.resolution, resolution))
+      return true;
+  return false;
+}
+
+void PixmapGraphicsItem::addTile(const QPixmap &pixmap, const qreal resolution,
+                                 const QPoint index, const int size) noexcept
+{
+  if (pixmap.isNull() || size <= 0) return;
+  if (size != tile_size) {
+    tiles.clear();
+    tile_size = size;
+  }
+  tiles.prepend({resolution, index, pixmap});
+  while (tiles.length() > preferences()->max_tiles) tiles.removeLast();
+  update();
+}
+
 void PixmapGraphicsItem::setRect(const QRectF &rect) noexcept
 {
   bounding_rect = rect;
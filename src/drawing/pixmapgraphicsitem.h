@@ -11,6 +11,7 @@
 #include <QSet>
 #include <QSizeF>
 #include <QtCore>
+#include <cmath>
 
 #include "src/config.h"
 #include "src/enumerates.h"
@@ -78,6 +79,32 @@ class PixmapGraphicsItem : public QGraphicsObject
   /// call to trackChanges().
   QSet<unsigned int> newHashs;
 
+  /// Width of preview pixmap, 0 if no preview is shown.
+  /// @see addPreview()
+  unsigned int preview_width = 0;
+
+  /// Tile of the page rendered with enlarged resolution.
+  struct Tile {
+    /// Resolution in pixels per point.
+    qreal resolution;
+    /// Position of the tile in units of tile_size.
+    QPoint index;
+    /// Image of the tile.
+    QPixmap pixmap;
+  };
+
+  /// Tiles, most recently added first.
+  QList<Tile> tiles;
+
+  /// Size (width and height) of tiles in pixels.
+  int tile_size = 0;
+
+  /// Check whether tiles with the given resolution fit the scale of painter.
+  static bool matchesScale(const qreal resolution, const qreal scale) noexcept
+  {
+    return std::abs(resolution - scale) < 1e-3 * scale;
+  }
+
  public:
   /// Type of this custom QGraphicsItem.
   enum { Type = UserType + PixmapGraphicsItemType };
@@ -99,6 +126,9 @@ class PixmapGraphicsItem : public QGraphicsObject
   /// 0.6
   bool hasWidth(const qreal width) const noexcept;
 
+  /// Check whether this contains a tile with given resolution and index.
+  bool hasTile(const qreal resolution, const QPoint index) const noexcept;
+
   /// Paint this on given painter.
   /// @param painter paint to this painter.
   /// @param option currently ignored.
@@ -128,17 +158,36 @@ class PixmapGraphicsItem : public QGraphicsObject
   int number() const noexcept { return pixmaps.size(); }
 
  public slots:
-  /// Add a pixmap.
+  /// Add a pixmap. Removes the preview if pixmap is at least as large.
   void addPixmap(const QPixmap &pixmap) noexcept;
 
+  /// Add a low resolution preview pixmap. Removes all pixmaps which were
+  /// added before the latest call to trackNew(). The preview is removed when
+  /// a larger pixmap is added. Does nothing if a pixmap of at least the
+  /// same size was already added since trackNew().
+  void addPreview(const QPixmap &pixmap) noexcept;
+
   /// Set (overwrite) bounding rect.
   void setRect(const QRectF &rect) noexcept;
 
   /// Set (overwrite) bounding rect size.
   void setSize(const QSizeF &size) noexcept { bounding_rect.setSize(size); }
 
+  /// Add a tile with given resolution and index (position in units of size).
+  /// Only the most recent preferences()->max_tiles tiles are kept.
+  void addTile(const QPixmap &pixmap, const qreal resolution,
+               const QPoint index, const int size) noexcept;
+
+  /// Remove all tiles.
+  void clearTiles() noexcept { tiles.clear(); }
+
   /// Clear everything.
-  void clearPixmaps() noexcept { pixmaps.clear(); }
+  void clearPixmaps() noexcept
+  {
+    pixmaps.clear();
+    tiles.clear();
+    preview_width = 0;
+  }
 
   /// Start tracking changes.
   /// @see clearOld()
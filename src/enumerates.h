@@ -102,6 +102,34 @@ enum class Renderer {
 
 Q_DECLARE_METATYPE(Renderer);
 
+/// Compression of page images stored in the cache (PixCache).
+enum class CacheCodec {
+  /// Unknown codec, used to indicate invalid user input
+  InvalidCodec = -1,
+  /// PNG compression: small images, but slow encoding and decoding.
+  PNG = 0,
+  /// Raw pixel data compressed with zlib on the fastest level.
+  Fast = 1,
+  /// Uncompressed raw pixel data.
+  Uncompressed = 2,
+};
+
+Q_DECLARE_METATYPE(CacheCodec);
+
+/// Strategy for choosing the pages which are rendered to cache in the
+/// background (PixCache).
+enum class PrefetchMode {
+  /// Unknown mode, used to indicate invalid user input
+  InvalidPrefetch = -1,
+  /// Cache pages around the current page, mainly ahead of it.
+  Linear = 0,
+  /// Additionally predict pages from the slide order, overlays, links and
+  /// the direction of recent navigation.
+  Navigation = 1,
+};
+
+Q_DECLARE_METATYPE(PrefetchMode);
+
 /// Mode for handling drawings in overlays.
 /// Overlays are PDF pages sharing the same label.
 enum class OverlayDrawingMode {
@@ -191,6 +219,7 @@ enum Action {
   LoadDrawingsNoClear,  ///< load drawings from file without clearing existing
                         ///< drawings (better don't use that!)
   ExportDrawingsSvg,    ///< Export drawings to SVG images.
+  ExportPages,          ///< Export all pages including drawings.
   // Modify drawn items
   CopyClipboard,          ///< copy selection to clipboard
   CutClipboard,           ///< cut selection to clipboard
@@ -281,6 +310,7 @@ enum GuiWidget {
   TimerType,          ///< TimerWidget
   SlideNumberType,    ///< SlideNumberWidget
   SlideLabelType,     ///< SlideLabelWidget
+  StatisticsType,     ///< StatisticsWidget
 };
 
 /// Integer values added to QGraphicsItem::UserType to define custom
@@ -4,18 +4,25 @@
 #include "src/gui/searchwidget.h"
 
 #include <QHBoxLayout>
+#include <QLabel>
 #include <QLineEdit>
+#include <QListWidget>
 #include <QPair>
 #include <QRectF>
 #include <QToolButton>
+#include <QVBoxLayout>
 
 #include "src/preferences.h"
+#include "src/rendering/pdfdocument.h"
 
 SearchWidget::SearchWidget(QWidget *parent)
     : QWidget{parent},
       search_field{new QLineEdit(this)},
       forward_button{new QToolButton(this)},
-      backward_button{new QToolButton(this)}
+      backward_button{new QToolButton(this)},
+      all_button{new QToolButton(this)},
+      result_list{new QListWidget(this)},
+      status_label{new QLabel(this)}
 {
   search_field->setPlaceholderText(tr("search..."));
   search_field->setToolTip(tr("enter search text"));
@@ -37,7 +44,16 @@ SearchWidget::SearchWidget(QWidget *parent)
     forward_button->setText(">");
   else
     forward_button->setIcon(icon);
-  backward_button->setToolTip(tr("go to next matching slide"));
+  forward_button->setToolTip(tr("go to next matching slide"));
+  icon = QIcon::fromTheme("edit-find");
+  if (icon.isNull()) icon = QIcon::fromTheme("edit-find-symbolic");
+  if (icon.isNull())
+    all_button->setText(tr("all"));
+  else
+    all_button->setIcon(icon);
+  all_button->setToolTip(tr("list matches on all slides"));
+  result_list->hide();
+  status_label->hide();
   // layout
   setMinimumHeight(16);
   search_field->setSizePolicy(QSizePolicy::Expanding,
@@ -46,10 +62,17 @@ SearchWidget::SearchWidget(QWidget *parent)
                                  QSizePolicy::MinimumExpanding);
   forward_button->setSizePolicy(QSizePolicy::Minimum,
                                 QSizePolicy::MinimumExpanding);
-  QHBoxLayout *layout = new QHBoxLayout(this);
-  layout->addWidget(search_field);
-  layout->addWidget(backward_button);
-  layout->addWidget(forward_button);
+  all_button->setSizePolicy(QSizePolicy::Minimum,
+                            QSizePolicy::MinimumExpanding);
+  QHBoxLayout *row = new QHBoxLayout();
+  row->addWidget(search_field);
+  row->addWidget(backward_button);
+  row->addWidget(forward_button);
+  row->addWidget(all_button);
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addLayout(row);
+  layout->addWidget(result_list, 1);
+  layout->addWidget(status_label);
   setLayout(layout);
   // connections
   connect(search_field, &QLineEdit::returnPressed, this,
@@ -58,6 +81,11 @@ SearchWidget::SearchWidget(QWidget *parent)
           &SearchWidget::searchForward);
   connect(backward_button, &QToolButton::clicked, this,
           &SearchWidget::searchBackward);
+  connect(all_button, &QToolButton::clicked, this, &SearchWidget::searchAll);
+  connect(result_list, &QListWidget::itemActivated, this,
+          &SearchWidget::selectResult);
+  connect(result_list, &QListWidget::itemClicked, this,
+          &SearchWidget::selectResult);
 }
 
 SearchWidget::~SearchWidget()
@@ -65,6 +93,9 @@ SearchWidget::~SearchWidget()
   delete search_field;
   delete forward_button;
   delete backward_button;
+  delete all_button;
+  delete result_list;
+  delete status_label;
 }
 
 void SearchWidget::search(qint8 forward)
@@ -72,3 +103,53 @@ void SearchWidget::search(qint8 forward)
   const QString &text = search_field->text();
   emit searchPdf(text, preferences()->page + forward, forward >= 0);
 }
+
+void SearchWidget::searchAll()
+{
+  const QString &text = search_field->text();
+  if (text.isEmpty()) return;
+  emit searchAllPdf(text);
+  status_label->setText(tr("searching..."));
+  status_label->show();
+}
+
+void SearchWidget::clearResults()
+{
+  result_list->clear();
+  result_list->hide();
+  results.clear();
+  hits = 0;
+  status_label->hide();
+}
+
+void SearchWidget::addResult(const int page, const int count,
+                             const QList<QRectF> &rects, const QString &snippet)
+{
+  results[page] = rects;
+  hits += count;
+  const auto document = preferences()->document;
+  const QString label =
+      document ? document->pageLabel(page) : QString::number(page + 1);
+  QListWidgetItem *item = new QListWidgetItem(
+      QString("%1 (%2): %3").arg(label).arg(count).arg(snippet), result_list);
+  item->setData(Qt::UserRole, page);
+  result_list->show();
+  status_label->setText(tr("searching... %1 matches").arg(hits));
+}
+
+void SearchWidget::finishResults(const int total)
+{
+  if (total > 0)
+    status_label->setText(
+        tr("%1 matches on %2 slides").arg(total).arg(results.size()));
+  else
+    status_label->setText(tr("no matches"));
+  status_label->show();
+}
+
+void SearchWidget::selectResult(QListWidgetItem *item)
+{
+  if (!item) return;
+  const int page = item->data(Qt::UserRole).toInt();
+  emit showResult(page, results.value(page));
+}
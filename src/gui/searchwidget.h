@@ -5,22 +5,27 @@
 #define SEARCHWIDGET_H
 
 #include <QLineEdit>
+#include <QList>
+#include <QMap>
+#include <QRectF>
 
 #include "src/config.h"
 
 class QFocusEvent;
+class QLabel;
+class QListWidget;
+class QListWidgetItem;
 class QToolButton;
 
 /**
  * @brief Widget for searching text in PDF
  *
- * Currently, this searches for the first occurrence of a text on a page.
- * This first occurrence is highlighted. If the text is not found on the
- * current page, the following pages are searched. This nagivates to the
- * page on which the text is found.
+ * The forward and backward buttons search for the next page containing the
+ * text, navigate to this page and highlight all occurrences on it.
  *
- * @todo shift search to separate thread
- * @todo indicate failed search
+ * The third button searches all pages. Matching pages are listed with the
+ * number of matches and a text snippet while the search is running.
+ * Selecting an entry navigates to the page and highlights the matches.
  */
 class SearchWidget : public QWidget
 {
@@ -32,6 +37,18 @@ class SearchWidget : public QWidget
   QToolButton *forward_button;
   /// button for backward search
   QToolButton *backward_button;
+  /// button for search in all pages
+  QToolButton *all_button;
+  /// list of pages with matches
+  QListWidget *result_list;
+  /// number of matches or search status
+  QLabel *status_label;
+
+  /// outline of matches for each page in result_list
+  QMap<int, QList<QRectF>> results;
+
+  /// number of matches in result_list
+  int hits = 0;
 
  protected:
   /// Focus event: focus search_field by default
@@ -67,10 +84,27 @@ class SearchWidget : public QWidget
   void searchForward() { search(1); }
   /// Search backwards starting on previous page.
   void searchBackward() { search(-1); }
+  /// Search in all pages and list the results.
+  void searchAll();
+  /// Show the matches of selected entry in result_list.
+  void selectResult(QListWidgetItem *item);
+
+ public slots:
+  /// Remove all entries from result_list.
+  void clearResults();
+  /// Add page with matches to result_list.
+  void addResult(const int page, const int count, const QList<QRectF> &rects,
+                 const QString &snippet);
+  /// Search in all pages finished with given number of matches.
+  void finishResults(const int total);
 
  signals:
   /// Text has been found on given page.
   void searchPdf(const QString &text, const int page, const bool forward);
+  /// Search text in all pages.
+  void searchAllPdf(const QString &text);
+  /// Navigate to page and highlight the given matches.
+  void showResult(const int page, const QList<QRectF> &rects);
 };
 
 #endif  // SEARCHWIDGET_H
@@ -163,6 +163,85 @@ void SettingsWidget::initRendering()
 #endif
   layout->addRow(tr("max. slides in cache"), spin_box);
 
+  spin_box = new QSpinBox(rendering);
+  spin_box->setMinimum(0);
+  spin_box->setMaximum(100);
+  spin_box->setValue(preferences()->max_decoded_pages);
+  spin_box->setToolTip(
+      tr("Number of slides around the current slide which are kept "
+         "uncompressed for fast navigation"));
+#if (QT_VERSION_MAJOR >= 6)
+  connect(spin_box, &QSpinBox::valueChanged,
+          WritableGlobalPreferences::writable(),
+          &Preferences::setDecodedPages);
+#else
+  connect(spin_box, QOverload<int>::of(&QSpinBox::valueChanged),
+          WritableGlobalPreferences::writable(),
+          &Preferences::setDecodedPages);
+#endif
+  layout->addRow(tr("decoded slides per cache"), spin_box);
+
+  spin_box = new QSpinBox(rendering);
+  spin_box->setMinimum(0);
+  spin_box->setMaximum(100000);
+  spin_box->setValue(preferences()->disk_cache_size / 1048576);
+  spin_box->setToolTip(
+      tr("Rendered slides are stored on disk and reused when the same "
+         "document is opened again. 0 disables the disk cache."));
+#if (QT_VERSION_MAJOR >= 6)
+  connect(spin_box, &QSpinBox::valueChanged,
+          WritableGlobalPreferences::writable(),
+          &Preferences::setDiskCacheSize);
+#else
+  connect(spin_box, QOverload<int>::of(&QSpinBox::valueChanged),
+          WritableGlobalPreferences::writable(),
+          &Preferences::setDiskCacheSize);
+#endif
+  layout->addRow(tr("disk cache (MiB)"), spin_box);
+
+  QCheckBox *mapped_box = new QCheckBox(tr("memory mapped cache"), rendering);
+  mapped_box->setChecked(preferences()->global_flags &
+                         Preferences::MappedCache);
+  mapped_box->setToolTip(
+      tr("Keep compressed slides in a temporary file which is mapped to "
+         "memory. The operating system decides how much of the cache is "
+         "kept in physical memory."));
+#if (QT_VERSION_MAJOR >= 6)
+  connect(mapped_box, &QCheckBox::clicked,
+          WritableGlobalPreferences::writable(), &Preferences::setMappedCache);
+#else
+  connect(mapped_box, QOverload<bool>::of(&QCheckBox::clicked),
+          WritableGlobalPreferences::writable(), &Preferences::setMappedCache);
+#endif
+  layout->addRow(mapped_box);
+
+  QComboBox *codec_box = new QComboBox(rendering);
+  for (auto it = get_string_to_cache_codec().cbegin();
+       it != get_string_to_cache_codec().cend(); ++it)
+    codec_box->addItem(it.key());
+  codec_box->setCurrentText(
+      get_string_to_cache_codec().key(preferences()->cache_codec));
+  codec_box->setToolTip(
+      tr("\"png\" gives the smallest cache, \"fast\" and \"none\" "
+         "need more memory but make showing cached slides faster."));
+  connect(codec_box, &QComboBox::currentTextChanged,
+          WritableGlobalPreferences::writable(), &Preferences::setCacheCodec);
+  layout->addRow(tr("cache compression"), codec_box);
+
+  QComboBox *prefetch_box = new QComboBox(rendering);
+  for (auto it = get_string_to_prefetch_mode().cbegin();
+       it != get_string_to_prefetch_mode().cend(); ++it)
+    prefetch_box->addItem(it.key());
+  prefetch_box->setCurrentText(
+      get_string_to_prefetch_mode().key(preferences()->prefetch_mode));
+  prefetch_box->setToolTip(
+      tr("\"linear\" caches slides around the current slide, \"navigation\" "
+         "additionally uses links, overlays and the navigation direction to "
+         "predict the next slide."));
+  connect(prefetch_box, &QComboBox::currentTextChanged,
+          WritableGlobalPreferences::writable(), &Preferences::setPrefetchMode);
+  layout->addRow(tr("prefetch"), prefetch_box);
+
   // Renderer
   explanation_label = new QLabel(
       tr("Depending on your installation, different PDF engines may "
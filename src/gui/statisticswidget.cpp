@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/gui/statisticswidget.h"
+
+#include <QFont>
+#include <QHideEvent>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QScrollBar>
+#include <QShowEvent>
+#include <QTimerEvent>
+
+#include "src/rendering/renderstats.h"
+
+StatisticsWidget::StatisticsWidget(const int interval, QWidget *parent)
+    : QPlainTextEdit(parent), interval(interval > 0 ? interval : 1000)
+{
+  setReadOnly(true);
+  setFocusPolicy(Qt::NoFocus);
+  setLineWrapMode(QPlainTextEdit::NoWrap);
+  QFont thefont = font();
+  thefont.setFamily("monospace");
+  thefont.setStyleHint(QFont::Monospace);
+  setFont(thefont);
+}
+
+QString StatisticsWidget::format(const QJsonObject &stats)
+{
+  const auto histogram = [](const QJsonObject &obj) -> QString {
+    return QString("%1 × %2 ms (max %3 ms)")
+        .arg(obj.value("count").toInt())
+        .arg(obj.value("mean").toDouble(), 0, 'f', 1)
+        .arg(obj.value("max").toDouble(), 0, 'f', 1);
+  };
+  QString text;
+  for (const auto &value : stats.value("caches").toArray()) {
+    const QJsonObject cache = value.toObject();
+    text += cache.value("name").toString() + " [" +
+            cache.value("renderer").toString() + "]\n";
+    text += tr("  hit rate:     %1 % (%2 decoded, %3 compressed, %4 disk, "
+               "%5 missed)\n")
+                .arg(100 * cache.value("hit rate").toDouble(), 0, 'f', 1)
+                .arg(cache.value("decoded hits").toInt())
+                .arg(cache.value("hits").toInt())
+                .arg(cache.value("disk hits").toInt())
+                .arg(cache.value("misses").toInt());
+    text += tr("  memory:       %1 MiB (%2 MiB decoded)\n")
+                .arg(cache.value("bytes").toDouble() / 1048576, 0, 'f', 1)
+                .arg(cache.value("decoded bytes").toDouble() / 1048576, 0, 'f',
+                     1);
+    text += tr("  evictions:    %1\n").arg(cache.value("evictions").toInt());
+    text += tr("  render:       ") +
+            histogram(cache.value("render ms").toObject()) + "\n";
+    text += tr("  compress:     ") +
+            histogram(cache.value("compress ms").toObject()) + "\n";
+    text += tr("  decompress:   ") +
+            histogram(cache.value("decompress ms").toObject()) + "\n";
+  }
+  const QJsonObject renderers = stats.value("renderers").toObject();
+  for (auto it = renderers.constBegin(); it != renderers.constEnd(); ++it)
+    text += tr("renderer %1: ").arg(it.key()) +
+            histogram(it.value().toObject()) + "\n";
+  const QJsonObject pool = stats.value("render pool").toObject();
+  text += tr("render threads: %1, queued jobs: %2 (max %3)\n")
+              .arg(pool.value("threads").toInt())
+              .arg(pool.value("queued").toInt())
+              .arg(pool.value("max queued").toInt());
+  text += tr("navigation to page: ") +
+          histogram(stats.value("navigation to page ms").toObject()) + "\n";
+  return text;
+}
+
+void StatisticsWidget::updateText()
+{
+  const int position = verticalScrollBar()->value();
+  setPlainText(format(RenderStats::instance().toJson()));
+  verticalScrollBar()->setValue(position);
+}
+
+void StatisticsWidget::showEvent(QShowEvent *event)
+{
+  updateText();
+  if (timer_id < 0) timer_id = startTimer(interval);
+  QPlainTextEdit::showEvent(event);
+}
+
+void StatisticsWidget::hideEvent(QHideEvent *event)
+{
+  if (timer_id >= 0) killTimer(timer_id);
+  timer_id = -1;
+  QPlainTextEdit::hideEvent(event);
+}
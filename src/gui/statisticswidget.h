@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef STATISTICSWIDGET_H
+#define STATISTICSWIDGET_H
+
+#include <QPlainTextEdit>
+#include <QSize>
+
+#include "src/config.h"
+
+class QJsonObject;
+class QShowEvent;
+class QHideEvent;
+class QTimerEvent;
+
+/**
+ * @brief Read-only text showing cache and rendering statistics.
+ *
+ * This widget is mainly intended for debugging and tuning of the cache
+ * settings. It is not part of the default GUI but can be added in the
+ * GUI config with type "cache statistics". The statistics are updated
+ * periodically while the widget is visible.
+ *
+ * @see RenderStats
+ */
+class StatisticsWidget : public QPlainTextEdit
+{
+  Q_OBJECT
+
+  /// Update interval in ms.
+  int interval;
+
+  /// Timer id for updates, -1 if not running.
+  int timer_id = -1;
+
+  /// Format statistics as human readable text.
+  static QString format(const QJsonObject &stats);
+
+ public:
+  /// Constructor
+  explicit StatisticsWidget(const int interval = 1000,
+                            QWidget *parent = nullptr);
+
+  /// Trivial destructor
+  ~StatisticsWidget() {}
+
+  /// Size hint: based on estimated size.
+  QSize sizeHint() const noexcept override { return {300, 400}; }
+
+ protected:
+  /// Timer event: update text.
+  void timerEvent(QTimerEvent *) override { updateText(); }
+
+  /// Show event: update text and start timer.
+  void showEvent(QShowEvent *event) override;
+
+  /// Hide event: stop timer.
+  void hideEvent(QHideEvent *event) override;
+
+ public slots:
+  /// Read statistics and update text.
+  void updateText();
+};
+
+#endif  // STATISTICSWIDGET_H
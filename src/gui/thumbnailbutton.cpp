@@ -5,8 +5,10 @@
 
 #include <QKeyEvent>
 #include <QMouseEvent>
+#include <QPainter>
 #include <QPalette>
 #include <QString>
+#include <algorithm>
 
 ThumbnailButton::ThumbnailButton(const int page, QWidget *parent)
     : QLabel(parent), page(page)
@@ -70,3 +72,25 @@ bool ThumbnailButton::event(QEvent *event)
       return QLabel::event(event);
   }
 }
+
+void ThumbnailButton::paintEvent(QPaintEvent *event)
+{
+  QLabel::paintEvent(event);
+  if (search_hits <= 0) return;
+  // Show the number of matches in the upper right corner.
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing);
+  const QString text = QString::number(search_hits);
+  const QFontMetrics metrics = painter.fontMetrics();
+  const int height = metrics.height() + 4;
+  const int width = std::max(height, metrics.boundingRect(text).width() + 8);
+  const QRect rect(this->width() - width - line_width, line_width, width,
+                   height);
+  QColor color = preferences()->search_highlighting_color.color();
+  color.setAlpha(255);
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(color);
+  painter.drawRoundedRect(rect, height / 2., height / 2.);
+  painter.setPen(Qt::white);
+  painter.drawText(rect, Qt::AlignCenter, text);
+}
@@ -12,6 +12,7 @@
 class QMouseEvent;
 class QKeyEvent;
 class QFocusEvent;
+class QPaintEvent;
 
 /**
  * @brief Pushable button showing page preview
@@ -26,6 +27,9 @@ class ThumbnailButton : public QLabel
   /// index of the page represented by this thumbnail
   const int page;
 
+  /// number of search matches shown on this thumbnail
+  int search_hits = 0;
+
   /// Sent current page to master, adjust style
   void sendPage()
   {
@@ -83,6 +87,17 @@ class ThumbnailButton : public QLabel
     if (!hasFocus()) giveFocusInner();
   }
 
+  /// Number of search matches shown on this thumbnail.
+  int searchHits() const noexcept { return search_hits; }
+
+  /// Show number of search matches, 0 to hide.
+  void setSearchHits(const int hits)
+  {
+    if (hits == search_hits) return;
+    search_hits = hits;
+    update();
+  }
+
   /// Adjust style for unfocussed button.
   void clearFocus()
   {
@@ -101,6 +116,8 @@ class ThumbnailButton : public QLabel
   void focusInEvent(QFocusEvent *) override { giveFocusInner(); }
   /// only implements workaround for allowing touchscreen scrolling
   bool event(QEvent *event) override;
+  /// Paint thumbnail and number of search matches.
+  void paintEvent(QPaintEvent *event) override;
 
  signals:
   /// Send out navigation event for this page.
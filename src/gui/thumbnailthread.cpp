@@ -9,6 +9,7 @@
 #include "src/preferences.h"
 #include "src/rendering/abstractrenderer.h"
 #include "src/rendering/pdfdocument.h"
+#include "src/rendering/renderpool.h"
 #ifdef USE_EXTERNAL_RENDERER
 #include "src/rendering/externalrenderer.h"
 #endif
@@ -36,13 +37,24 @@ ThumbnailThread::ThumbnailThread(std::shared_ptr<const PdfDocument> document)
   }
 }
 
-void ThumbnailThread::timerEvent(QTimerEvent* event)
+ThumbnailThread::~ThumbnailThread()
 {
-  if (!renderer || queue.isEmpty())
-    killTimer(event->timerId());
-  else {
-    queue_entry entry = queue.takeFirst();
+  RenderPool::instance().cancel(this);
+  delete renderer;
+}
+
+void ThumbnailThread::renderNext()
+{
+  if (!renderer || queue.isEmpty()) {
+    busy = false;
+    return;
+  }
+  busy = true;
+  const queue_entry entry = queue.takeFirst();
+  RenderPool::instance().submit(this, RenderPool::Thumbnail, [this, entry]() {
     emit sendThumbnail(entry.button_index,
                        renderer->renderPixmap(entry.page, entry.resolution));
-  }
+    QMetaObject::invokeMethod(this, &ThumbnailThread::renderNext,
+                              Qt::QueuedConnection);
+  });
 }
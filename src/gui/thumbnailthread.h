@@ -15,15 +15,16 @@ class QPixmap;
 class PdfDocument;
 
 /**
- * @brief Worker object for rendering thumbnails in own thread
+ * @brief Worker object for rendering thumbnails in the RenderPool
  *
- * Created by ThumbnailWidget and moved to own thread, the ThumbnailThread
- * object renders thumbnail images and sends them to ThumbailWidget.
+ * Created by ThumbnailWidget, the ThumbnailThread object renders thumbnail
+ * images with low priority in the global RenderPool and sends them to
+ * ThumbailWidget. Only one thumbnail is rendered at a time.
  * The images are connected to the ThumbnailButtons, at which they will
  * be shown.
  *
- * The images are not directly shown in the buttons from this thread,
- * because that should happen in the main thread.
+ * The images are not directly shown in the buttons from the rendering
+ * thread, because that should happen in the main thread.
  *
  * @see ThumbnailWidget
  * @see ThumbnailButton
@@ -48,17 +49,18 @@ class ThumbnailThread : public QObject
   std::shared_ptr<const PdfDocument> document;
   /// queue of pages/thumbnails which should be rendered
   QList<queue_entry> queue;
+  /// true while a thumbnail is rendered in the RenderPool.
+  bool busy{false};
 
- protected:
-  /// Timer event: render next slide;
-  virtual void timerEvent(QTimerEvent *event);
+  /// Submit the next queued entry to the RenderPool.
+  void renderNext();
 
  public:
   /// Constructor: create renderer if document is not nullptr.
   ThumbnailThread(std::shared_ptr<const PdfDocument> document = nullptr);
 
-  /// Destructor: delete renderer.
-  ~ThumbnailThread() { delete renderer; }
+  /// Destructor: cancel rendering, delete renderer.
+  ~ThumbnailThread();
 
  public slots:
   /// Add entries to rendering queue.
@@ -71,7 +73,10 @@ class ThumbnailThread : public QObject
   void clearQueue() { queue.clear(); }
 
   /// Do the work: render thumbnails for the queued pages.
-  void renderImages() { startTimer(0); }
+  void renderImages()
+  {
+    if (!busy) renderNext();
+  }
 
  signals:
   /// Send thumbnail back to ThumbnailWidget, which sets the pixmap
@@ -11,9 +11,9 @@
 #include <QScroller>
 #include <QShowEvent>
 #include <QSizeF>
-#include <QThread>
 #include <algorithm>
 #include <cstdlib>
+#include <utility>
 
 #include "src/gui/thumbnailbutton.h"
 #include "src/gui/thumbnailthread.h"
@@ -35,11 +35,8 @@ ThumbnailWidget::ThumbnailWidget(std::shared_ptr<const PdfDocument> doc,
 ThumbnailWidget::~ThumbnailWidget()
 {
   emit interruptThread();
-  if (render_thread) {
-    render_thread->thread()->quit();
-    render_thread->thread()->wait(10000);
-    delete render_thread;
-  }
+  // Deleting render_thread waits until the current thumbnail is rendered.
+  delete render_thread;
 }
 
 void ThumbnailWidget::initialize()
@@ -134,14 +131,11 @@ void ThumbnailWidget::focusInEvent(QFocusEvent *event)
 void ThumbnailWidget::handleAction(const Action action)
 {
   if (action == PdfFilesChanged) {
+    if (updateChangedPages()) return;
     emit interruptThread();
     focused_button = nullptr;
-    if (render_thread) {
-      render_thread->thread()->quit();
-      render_thread->thread()->wait(max_render_time_ms);
-      delete render_thread;
-      render_thread = nullptr;
-    }
+    delete render_thread;
+    render_thread = nullptr;
     ref_width = -100;
     initialize();
     if (isVisible()) {
@@ -155,7 +149,6 @@ void ThumbnailWidget::initRenderingThread()
 {
   debug_msg(DebugWidgets, "initializing rendering thread");
   render_thread = new ThumbnailThread(document);
-  render_thread->moveToThread(new QThread(render_thread));
   connect(this, &ThumbnailWidget::interruptThread, render_thread,
           &ThumbnailThread::clearQueue, Qt::QueuedConnection);
   connect(this, &ThumbnailWidget::sendToRenderThread, render_thread,
@@ -164,8 +157,7 @@ void ThumbnailWidget::initRenderingThread()
           &ThumbnailThread::renderImages, Qt::QueuedConnection);
   connect(render_thread, &ThumbnailThread::sendThumbnail, this,
           &ThumbnailWidget::receiveThumbnail, Qt::QueuedConnection);
-  render_thread->thread()->start();
-  debug_msg(DebugWidgets, "started rendering thread");
+  debug_msg(DebugWidgets, "initialized rendering thread");
 }
 
 void ThumbnailWidget::generate()
@@ -184,9 +176,7 @@ void ThumbnailWidget::generate()
     initialize();
     layout = dynamic_cast<QGridLayout *>(widget()->layout());
   }
-  const int col_width =
-      (viewport()->width() - (columns + 1) * layout->horizontalSpacing()) /
-      columns;
+  const int col_width = columnWidth(layout);
   ref_width = width();
   int position = 0;
   if (_flags & SkipOverlays) {
@@ -226,6 +216,13 @@ void ThumbnailWidget::createButton(const int display_page, const int link_page,
             &ThumbnailWidget::moveFocusUpDown);
     layout->addWidget(button, position / columns, position % columns);
   }
+  // With skipped overlays, the button shows the maximum number of search
+  // matches of all pages it represents.
+  int hits = 0;
+  for (auto it = std::as_const(search_hits).lowerBound(link_page);
+       it != search_hits.cend() && it.key() <= display_page; ++it)
+    hits = std::max(hits, *it);
+  button->setSearchHits(hits);
   QSizeF size = document->pageSize(display_page);
   if (preferences()->default_page_part) size.rwidth() /= 2;
   button->setMinimumSize(col_width, col_width * size.height() / size.width());
@@ -234,6 +231,30 @@ void ThumbnailWidget::createButton(const int display_page, const int link_page,
       display_page);
 }
 
+int ThumbnailWidget::columnWidth(const QGridLayout *layout) const
+{
+  return (viewport()->width() - (columns + 1) * layout->horizontalSpacing()) /
+         columns;
+}
+
+bool ThumbnailWidget::updateChangedPages()
+{
+  if (!document || !render_thread || (_flags & SkipOverlays)) return false;
+  const QList<int> pages = document->changedPages();
+  QGridLayout *layout =
+      widget() ? dynamic_cast<QGridLayout *>(widget()->layout()) : nullptr;
+  // Buttons can only be kept if they still represent the same pages.
+  if (!layout || layout->count() != document->numberOfPages() ||
+      pages.length() >= document->numberOfPages())
+    return false;
+  debug_msg(DebugWidgets, "updating" << pages.length() << "thumbnails");
+  const int col_width = columnWidth(layout);
+  for (const int page : pages)
+    if (page < layout->count()) createButton(page, page, page, col_width);
+  emit startRendering();
+  return true;
+}
+
 void ThumbnailWidget::receiveThumbnail(const int button_index,
                                        const QPixmap pixmap)
 {
@@ -278,3 +299,22 @@ void ThumbnailWidget::moveFocusUpDown(const qint8 updown)
     ensureWidgetVisible(focused_button);
   }
 }
+
+void ThumbnailWidget::addSearchHits(const int page, const int count)
+{
+  search_hits[page] = count;
+  ThumbnailButton *button = buttonAtPage(page);
+  if (button) button->setSearchHits(std::max(button->searchHits(), count));
+}
+
+void ThumbnailWidget::clearSearchHits()
+{
+  search_hits.clear();
+  QLayout *layout = widget() ? widget()->layout() : nullptr;
+  if (!layout) return;
+  for (int i = 0; i < layout->count(); ++i) {
+    ThumbnailButton *button =
+        dynamic_cast<ThumbnailButton *>(layout->itemAt(i)->widget());
+    if (button) button->setSearchHits(0);
+  }
+}
@@ -4,6 +4,8 @@
 #ifndef THUMBNAILWIDGET_H
 #define THUMBNAILWIDGET_H
 
+#include <QList>
+#include <QMap>
 #include <QScrollArea>
 #include <QSize>
 #include <memory>
@@ -15,6 +17,7 @@
 class QShowEvent;
 class QKeyEvent;
 class QFocusEvent;
+class QGridLayout;
 class QPixmap;
 class PdfDocument;
 class ThumbnailThread;
@@ -34,9 +37,6 @@ class ThumbnailWidget : public QScrollArea
   /// inverse tolerance for widget size changes for recalculating buttons
   static constexpr int inverse_tolerance = 10;
 
-  /// maximum waiting time for rendering (ms)
-  static constexpr int max_render_time_ms = 2000;
-
  public:
   enum ThumbnailFlag {
     /// show one thumbnail per page label instead of per page
@@ -46,9 +46,9 @@ class ThumbnailWidget : public QScrollArea
   Q_FLAG(ThumbnailFlags);
 
  private:
-  /// QObject for rendering. which is moved to an own thread.
+  /// QObject for rendering, which submits jobs to the RenderPool.
   /// Communication to render_thread is almost exclusively done via the
-  /// signal/slot mechanism since it lives in another thread.
+  /// signal/slot mechanism.
   ThumbnailThread *render_thread{nullptr};
   /// Document shown by these thumbnails.
   std::shared_ptr<const PdfDocument> document;
@@ -63,6 +63,8 @@ class ThumbnailWidget : public QScrollArea
   ThumbnailButton *focused_button{nullptr};
   /// button for current page
   ThumbnailButton *current_page_button{nullptr};
+  /// number of search matches per page
+  QMap<int, int> search_hits;
 
   /// Create widget and layout.
   void initialize();
@@ -75,6 +77,13 @@ class ThumbnailWidget : public QScrollArea
   void createButton(const int display_page, const int link_page,
                     const int position, const int col_width);
 
+  /// Width of a column in the layout in pixels.
+  int columnWidth(const QGridLayout *layout) const;
+
+  /// Render thumbnails of changed pages again after the document has been
+  /// reloaded. Return false if all thumbnails need to be generated again.
+  bool updateChangedPages();
+
  protected:
   /// Resize: clear if necessary.
   void resizeEvent(QResizeEvent *) override;
@@ -136,6 +145,12 @@ class ThumbnailWidget : public QScrollArea
   /// Move focus to row above/below (updown=-1/+1)
   void moveFocusUpDown(const qint8 updown);
 
+  /// Show number of search matches on the thumbnail of page.
+  void addSearchHits(const int page, const int count);
+
+  /// Hide all numbers of search matches.
+  void clearSearchHits();
+
   /// Focus in event: make sure a thumbnail button is focussed.
   void focusInEvent(QFocusEvent *event) override;
 
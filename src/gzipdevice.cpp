@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/gzipdevice.h"
+
+#include <algorithm>
+
+#include "src/log.h"
+
+GzipDevice::GzipDevice(QIODevice *target, const int level)
+    : target(target), level(level)
+{
+}
+
+bool GzipDevice::open(OpenMode mode)
+{
+  if (isOpen() || !target || !target->isWritable() ||
+      (mode & ReadOnly) || !(mode & WriteOnly))
+    return false;
+  stream = z_stream{};
+  // Window bits 15 + 16 selects the gzip format.
+  if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    qWarning() << "Initializing zlib failed";
+    return false;
+  }
+  buffer.resize(chunk_size);
+  failed = false;
+  return QIODevice::open(mode);
+}
+
+bool GzipDevice::deflateTo(const int flush)
+{
+  int status;
+  do {
+    stream.next_out = reinterpret_cast<Bytef *>(buffer.data());
+    stream.avail_out = chunk_size;
+    status = deflate(&stream, flush);
+    if (status == Z_STREAM_ERROR) return false;
+    const qint64 length = chunk_size - stream.avail_out;
+    if (length > 0 && target->write(buffer.constData(), length) != length)
+      return false;
+  } while (stream.avail_out == 0);
+  return flush != Z_FINISH || status == Z_STREAM_END;
+}
+
+qint64 GzipDevice::writeData(const char *data, qint64 len)
+{
+  if (failed) return -1;
+  qint64 written = 0;
+  // avail_in is an unsigned int: split very large blocks.
+  while (written < len) {
+    const uInt size = std::min<qint64>(len - written, 1 << 30);
+    stream.next_in =
+        reinterpret_cast<Bytef *>(const_cast<char *>(data + written));
+    stream.avail_in = size;
+    if (!deflateTo(Z_NO_FLUSH)) {
+      failed = true;
+      return -1;
+    }
+    written += size;
+  }
+  return written;
+}
+
+void GzipDevice::close()
+{
+  if (!isOpen()) return;
+  stream.next_in = nullptr;
+  stream.avail_in = 0;
+  if (!failed && !deflateTo(Z_FINISH)) failed = true;
+  deflateEnd(&stream);
+  buffer.clear();
+  QIODevice::close();
+}
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef GZIPDEVICE_H
+#define GZIPDEVICE_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <zlib.h>
+
+#include "src/config.h"
+
+/**
+ * @brief Write-only device compressing all data in gzip format.
+ *
+ * Data written to this device is compressed incrementally and written to
+ * the target device, which must be opened for writing. The gzip stream is
+ * completed by close().
+ */
+class GzipDevice : public QIODevice
+{
+  /// Size of the output buffer.
+  static constexpr int chunk_size = 1 << 16;
+
+  /// Device receiving the compressed data.
+  QIODevice *const target;
+
+  /// Compression level.
+  const int level;
+
+  /// zlib state.
+  z_stream stream{};
+
+  /// Buffer for compressed data.
+  QByteArray buffer;
+
+  /// An error occurred while compressing or writing.
+  bool failed = false;
+
+  /// Compress data with given flush mode and write it to target.
+  bool deflateTo(const int flush);
+
+ protected:
+  /// Reading is not supported.
+  qint64 readData(char *, qint64) override { return -1; }
+
+  /// Compress data and write the result to target.
+  qint64 writeData(const char *data, qint64 len) override;
+
+ public:
+  /// Constructor: target is not owned by this.
+  explicit GzipDevice(QIODevice *target,
+                      const int level = Z_DEFAULT_COMPRESSION);
+
+  /// Destructor: finish the gzip stream.
+  ~GzipDevice() { close(); }
+
+  /// Open for writing, other modes are not supported.
+  bool open(OpenMode mode) override;
+
+  /// Finish the gzip stream and close.
+  void close() override;
+
+  /// Return true if compressing or writing failed.
+  bool hasError() const noexcept { return failed; }
+
+  /// Sequential device.
+  bool isSequential() const override { return true; }
+};
+
+#endif  // GZIPDEVICE_H
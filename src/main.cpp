@@ -3,15 +3,22 @@
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QFile>
 #include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSettings>
+#include <QTimer>
 #include <QtDebug>
 #include <memory>
 
+#include "src/batchexport.h"
 #include "src/config.h"
 #include "src/drawing/tool.h"
 #include "src/master.h"
 #include "src/masterapp.h"
+#include "src/names.h"
+#include "src/navigationbenchmark.h"
 #include "src/preferences.h"
 #include "src/rendering/pngpixmap.h"
 
@@ -48,6 +55,17 @@ int main(int argc, char *argv[])
   qRegisterMetaType<std::shared_ptr<PointingTool>>(
       "std::shared_ptr<PointingTool>");
 
+  // The navigation benchmark and the export use the real GUI, but do not
+  // need a display.
+  for (int i = 1; i < argc; ++i) {
+    if (qstrncmp(argv[i], "--benchmark-navigation", 22) == 0 ||
+        qstrncmp(argv[i], "--export", 8) == 0) {
+      if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+      break;
+    }
+  }
+
   // Set up the application.
   MasterApp app(argc, argv);
   QString fallback_root = QCoreApplication::applicationDirPath();
@@ -86,6 +104,12 @@ int main(int argc, char *argv[])
                   "main", "log slide changes to standard output")});
   parser.addOption(
       {"nocache", QCoreApplication::translate("main", "disable cache")});
+  parser.addOption(
+      {"statistics",
+       QCoreApplication::translate("main",
+                                   "periodically append cache and rendering "
+                                   "statistics to file"),
+       QCoreApplication::translate("main", "file")});
   parser.addOption(
       {"renderer",
        QCoreApplication::translate("main", "available PDF renderers:") +
@@ -115,6 +139,20 @@ int main(int argc, char *argv[])
   // debugging options and messages are not translated.
   parser.addOption({"debug", "debug flags, comma-separated", "flags"});
 #endif
+  parser.addOption(
+      {"benchmark-navigation",
+       QCoreApplication::translate(
+           "main",
+           "measure navigation latency without showing windows and print "
+           "results as JSON. Sequences: sequential, random, overlays, all"),
+       QCoreApplication::translate("main", "sequences")});
+  parser.addOption(
+      {"export",
+       QCoreApplication::translate(
+           "main",
+           "export all pages including drawings to a PDF file or to PNG "
+           "images and quit"),
+       QCoreApplication::translate("main", "file")});
   parser.addOption(
       {"test", QCoreApplication::translate(
                    "main", "only test the installation, don't start the app")});
@@ -176,7 +214,7 @@ int main(int argc, char *argv[])
     qInfo() << "Running in test mode.";
     qInfo() << "Using GUI config file" << gui_config_file;
     qInfo() << "PDF file alias:" << preferences()->file_alias;
-  } else {
+  } else if (!parser.isSet("export")) {
     master()->showAll();
   }
   // Navigate to first page.
@@ -187,7 +225,44 @@ int main(int argc, char *argv[])
                    &Master::distributeMemory);
   // Run the program.
   int status = 0;
-  if (!parser.isSet("test")) status = app.exec();
+  if (parser.isSet("benchmark-navigation") && !parser.isSet("test")) {
+    QStringList sequences = parser.value("benchmark-navigation").split(',');
+    if (sequences.contains("all"))
+      sequences = QStringList{"sequential", "random", "overlays"};
+    NavigationBenchmark benchmark(sequences);
+    QObject::connect(&benchmark, &NavigationBenchmark::finished, &app, [&]() {
+      const QJsonObject output{
+          {"renderer", renderer_name(preferences()->renderer)},
+          {"memory", preferences()->max_memory},
+          {"rendering threads", preferences()->rendering_threads},
+          {"gui config", gui_config_file},
+          {"sequences", benchmark.getResults()},
+          {"statistics", master()->renderStatistics()},
+      };
+      QFile out;
+      out.open(stdout, QIODevice::WriteOnly);
+      out.write(QJsonDocument(output).toJson());
+      out.close();
+      app.exit(0);
+    });
+    QTimer::singleShot(0, &benchmark, &NavigationBenchmark::start);
+    status = app.exec();
+  } else if (parser.isSet("export") && !parser.isSet("test")) {
+    BatchExport *job = master()->exportPages(parser.value("export"));
+    if (job) {
+      QObject::connect(job, &BatchExport::progress,
+                       [](const int done, const int total) {
+                         qInfo().noquote()
+                             << QString("exported %1/%2").arg(done).arg(total);
+                       });
+      QObject::connect(job, &BatchExport::finished, &app,
+                       [&app](const bool success) { app.exit(!success); });
+      job->start();
+      status = app.exec();
+    } else
+      status = 1;
+  } else if (!parser.isSet("test"))
+    status = app.exec();
   // Clean up. preferences() must be deleted after everything else.
   // Deleting master may take some time since this requires the interruption
   // and deletion of multiple threads.
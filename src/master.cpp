@@ -3,8 +3,7 @@
 
 #include "src/master.h"
 
-#include <zlib.h>
-
+#include <QDateTime>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QJsonArray>
@@ -15,6 +14,7 @@
 #include <QMainWindow>
 #include <QMessageBox>
 #include <QMimeDatabase>
+#include <QProgressDialog>
 #include <QSizeF>
 #include <QString>
 #include <QThread>
@@ -23,8 +23,11 @@
 #include <QXmlStreamWriter>
 #include <QtConfig>
 #include <algorithm>
+#include <memory>
 #include <utility>
 
+#include "src/batchexport.h"
+#include "src/bprwriter.h"
 #include "src/config.h"
 #include "src/drawing/tool.h"
 #include "src/gui/analogclockwidget.h"
@@ -35,6 +38,7 @@
 #include "src/gui/settingswidget.h"
 #include "src/gui/slidelabelwidget.h"
 #include "src/gui/slidenumberwidget.h"
+#include "src/gui/statisticswidget.h"
 #include "src/gui/stackedwidget.h"
 #include "src/gui/tabwidget.h"
 #include "src/gui/thumbnailwidget.h"
@@ -47,11 +51,15 @@
 #include "src/pdfmaster.h"
 #include "src/preferences.h"
 #include "src/rendering/pixcache.h"
+#include "src/rendering/renderstats.h"
 #include "src/slidescene.h"
 #include "src/slideview.h"
 
 Master::~Master()
 {
+  // Wait until drawings are saved.
+  finishSave();
+  if (statisticsTimer_id != -1) writeStatistics();
   emit clearCache();
   for (const auto cache : std::as_const(caches)) cache->thread()->quit();
   for (const auto cache : std::as_const(caches)) {
@@ -148,6 +156,8 @@ Master::Status Master::readGuiConfig(const QString &filename)
   for (const auto &path : loaded_paths) loadBprDrawings(path, true);
   debug_msg(DebugDrawing, "Loaded drawings:" << known_files.size()
                                              << preferences()->file_alias);
+  if (!preferences()->statistics_file.isEmpty() && statisticsTimer_id == -1)
+    statisticsTimer_id = startTimer(preferences()->statistics_interval);
   return Success;
 }
 
@@ -168,6 +178,7 @@ void Master::initializePageIndex()
       page_to_slide[j] = i;
     }
   }
+  emit slideOrderChanged(page_idx);
 }
 
 void Master::removeSlide(const int slide)
@@ -181,6 +192,7 @@ void Master::removeSlide(const int slide)
   while (--i >= slide && it != page_idx.crend()) page_to_slide[*it++] = i;
   debug_msg(DebugPageChange, "removed slide" << slide << ", page" << page);
   debug_msg(DebugPageChange, "new page index:" << page_idx);
+  emit slideOrderChanged(page_idx);
 }
 
 void Master::insertSlideAt(const int slide, const int page)
@@ -192,6 +204,7 @@ void Master::insertSlideAt(const int slide, const int page)
   while (--i >= slide && it != page_idx.crend()) page_to_slide[*it++] = i;
   debug_msg(DebugPageChange, "inserted slide" << slide << ", page" << page);
   debug_msg(DebugPageChange, "new page index:" << page_idx);
+  emit slideOrderChanged(page_idx);
 }
 
 QWidget *Master::createWidget(
@@ -256,6 +269,10 @@ QWidget *Master::createWidget(
               &ThumbnailWidget::handleAction, Qt::QueuedConnection);
       connect(this, &Master::navigationSignal, twidget,
               &ThumbnailWidget::receivePage, Qt::QueuedConnection);
+      connect(this, &Master::searchHitsCleared, twidget,
+              &ThumbnailWidget::clearSearchHits);
+      connect(this, &Master::searchHit, twidget,
+              &ThumbnailWidget::addSearchHits);
       break;
     }
     case TOCType: {
@@ -340,12 +357,25 @@ QWidget *Master::createWidget(
       widget = new SettingsWidget(parent);
       break;
     case SearchType: {
-      widget = new SearchWidget(parent);
-      connect(static_cast<SearchWidget *>(widget), &SearchWidget::searchPdf,
-              this,
+      auto swidget = new SearchWidget(parent);
+      widget = swidget;
+      connect(swidget, &SearchWidget::searchPdf, this,
               [&](const QString &text, const int page, const bool forward) {
                 documents.first()->search(text, page, forward);
               });
+      connect(swidget, &SearchWidget::searchAllPdf, this,
+              [&](const QString &text) {
+                documents.first()->searchAllPages(text);
+              });
+      connect(swidget, &SearchWidget::showResult, this,
+              [&](const int page, const QList<QRectF> &results) {
+                documents.first()->showSearchResults(page, results);
+              });
+      connect(this, &Master::searchHitsCleared, swidget,
+              &SearchWidget::clearResults);
+      connect(this, &Master::searchHit, swidget, &SearchWidget::addResult);
+      connect(this, &Master::searchAllFinished, swidget,
+              &SearchWidget::finishResults);
       break;
     }
     case ClockType:
@@ -416,6 +446,10 @@ QWidget *Master::createWidget(
               static_cast<SlideLabelWidget *>(widget),
               &SlideLabelWidget::receivePage, Qt::QueuedConnection);
       break;
+    case StatisticsType:
+      widget = new StatisticsWidget(object.value("interval").toInt(1000),
+                                    parent);
+      break;
     case GuiWidget::InvalidType:
       showErrorMessage(tr("Error while reading GUI config"),
                        tr("Ignoring entry in GUI config with invalid type ") +
@@ -683,6 +717,11 @@ std::shared_ptr<PdfMaster> Master::createPdfMaster(QString abs_path)
   connect(pdf.get(), &PdfMaster::setTotalTime, this, &Master::setTotalTime);
   connect(pdf.get(), &PdfMaster::sendPage, this, &Master::navigateToPage,
           Qt::DirectConnection);
+  connect(pdf.get(), &PdfMaster::searchHitsCleared, this,
+          &Master::searchHitsCleared);
+  connect(pdf.get(), &PdfMaster::searchHit, this, &Master::searchHit);
+  connect(pdf.get(), &PdfMaster::searchAllFinished, this,
+          &Master::searchAllFinished);
 
   // Initialize document, try to laod PDF
   // TODO: should this be done at this point?
@@ -746,6 +785,12 @@ const PixCache *Master::getPixcache(const std::shared_ptr<PdfDocument> &doc,
           Qt::QueuedConnection);
   connect(this, &Master::clearCache, pixcache, &PixCache::clear,
           Qt::QueuedConnection);
+  connect(this, &Master::invalidatePages, pixcache,
+          &PixCache::invalidatePages, Qt::QueuedConnection);
+  connect(this, &Master::slideOrderChanged, pixcache,
+          &PixCache::setSlideOrder, Qt::QueuedConnection);
+  // The thread is not running yet, so this can be called directly.
+  pixcache->setSlideOrder(page_idx);
   // Start the thread.
   pixcache->thread()->start();
   return pixcache;
@@ -895,20 +940,71 @@ void Master::handleAction(const Action action)
     case ExportDrawingsSvg:
       for (auto pdf : documents) pdf->exportAllSvg();
       break;
+    case ExportPages: {
+      const QString filename = QFileDialog::getSaveFileName(
+          nullptr, tr("Export pages"), "",
+          tr("PDF file (*.pdf);;PNG images (*.png)"));
+      if (filename.isEmpty()) break;
+      BatchExport *job = exportPages(filename);
+      if (!job) break;
+      QProgressDialog *dialog = new QProgressDialog(
+          tr("Exporting pages..."), tr("Cancel"), 0, job->pages(),
+          windows.isEmpty() ? nullptr : windows.first());
+      dialog->setMinimumDuration(500);
+      connect(job, &BatchExport::progress, dialog, &QProgressDialog::setValue);
+      connect(dialog, &QProgressDialog::canceled, job, &BatchExport::cancel);
+      connect(job, &BatchExport::finished, dialog, &QObject::deleteLater);
+      connect(job, &BatchExport::finished, this,
+              [filename](bool success, bool was_cancelled) {
+                // Cancelling the export is not an error.
+                if (!success && !was_cancelled)
+                  preferences()->showErrorMessage(
+                      tr("Export failed"),
+                      tr("Some pages could not be exported to ") + filename);
+              });
+      job->start();
+      break;
+    }
     case ReloadFiles: {
       // TODO: problems with slide labels, navigation, and videos after
       // reloading files
-      bool changed = false;
+      QList<std::shared_ptr<PdfMaster>> reloaded;
       for (const auto &doc : std::as_const(documents))
-        changed |= doc->loadDocument();
-      if (changed) {
-        initializePageIndex();
-        WritableGlobalPreferences::writable()->number_of_pages =
-            documents.first()->numberOfPages();
-        distributeMemory();
-        emit clearCache();
-        emit sendAction(PdfFilesChanged);
-        navigateToSlide(preferences()->slide);
+        if (doc->loadDocument()) reloaded.append(doc);
+      if (reloaded.isEmpty()) break;
+      initializePageIndex();
+      WritableGlobalPreferences::writable()->number_of_pages =
+          documents.first()->numberOfPages();
+      distributeMemory();
+      // Changed pages may be computed in the background. Views are updated
+      // once the changes of all reloaded documents are known.
+      const auto remaining = std::make_shared<int>(reloaded.length());
+      for (const auto &doc : std::as_const(reloaded)) {
+        const std::shared_ptr<PdfDocument> document = doc->getDocument();
+        const std::weak_ptr<PdfDocument> weak_document = document;
+        const QString filename = doc->getFilename();
+        document->whenChangesKnown([this, weak_document, filename,
+                                    remaining]() {
+          // This may be called from a worker thread.
+          QMetaObject::invokeMethod(
+              this,
+              [this, weak_document, filename, remaining]() {
+                const auto document = weak_document.lock();
+                if (document) {
+                  // Only pages with changed content need to be rendered
+                  // again.
+                  const QList<int> pages = document->changedPages();
+                  debug_msg(DebugCache, "reloaded" << filename << "with"
+                                                   << pages.length()
+                                                   << "changed pages");
+                  if (!pages.isEmpty()) emit invalidatePages(filename, pages);
+                }
+                if (--*remaining > 0) return;
+                emit sendAction(PdfFilesChanged);
+                navigateToSlide(preferences()->slide);
+              },
+              Qt::QueuedConnection);
+        });
       }
       break;
     }
@@ -994,7 +1090,9 @@ bool Master::askCloseConfirmation() noexcept
       case QMessageBox::Save: {
         QString filename = doc->drawingsPath();
         if (filename.isEmpty()) filename = getSaveFileName();
-        saveBpr(filename);
+        // Only quit if the drawings were saved successfully.
+        if (filename.isEmpty() || !saveBpr(filename) || !finishSave())
+          return false;
         break;
       }
       default:
@@ -1043,7 +1141,8 @@ void Master::distributeMemory()
 qint64 Master::getTotalCache() const
 {
   qint64 cache = 0;
-  for (const auto px : std::as_const(caches)) cache += px->getUsedMemory();
+  for (const auto px : std::as_const(caches))
+    cache += px->getUsedMemory() + px->getDecodedMemory();
   return cache;
 }
 
@@ -1059,6 +1158,7 @@ void Master::navigateToSlide(const int slide)
     killTimer(slideDurationTimer_id);
     slideDurationTimer_id = -1;
   }
+  RenderStats::instance().navigationStarted();
   leaveSlide(preferences()->slide);
   const int page = pageForSlide(slide);
   emit prepareNavigationSignal(slide, page);
@@ -1123,6 +1223,15 @@ QString Master::getOpenFileName()
          "files (*)"));
 }
 
+BatchExport *Master::exportPages(const QString &target)
+{
+  if (documents.isEmpty() || target.isEmpty()) return nullptr;
+  BatchExport *job = new BatchExport(documents.first().get(), target,
+                                     preferences()->export_dpi, this);
+  connect(job, &BatchExport::finished, job, &QObject::deleteLater);
+  return job;
+}
+
 QString Master::getSaveFileName()
 {
   return QFileDialog::getSaveFileName(
@@ -1135,6 +1244,10 @@ void Master::timerEvent(QTimerEvent *event)
   debug_msg(DebugPageChange, "timer event" << event->timerId()
                                            << cacheVideoTimer_id
                                            << slideDurationTimer_id);
+  if (event->timerId() == statisticsTimer_id) {
+    writeStatistics();
+    return;
+  }
   killTimer(event->timerId());
   if (event->timerId() == cacheVideoTimer_id) {
     cacheVideoTimer_id = -1;
@@ -1145,49 +1258,83 @@ void Master::timerEvent(QTimerEvent *event)
   }
 }
 
+QJsonObject Master::renderStatistics() const
+{
+  return RenderStats::instance().toJson();
+}
+
+void Master::writeStatistics() const
+{
+  QFile file(preferences()->statistics_file);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qWarning() << "Could not write statistics to file" << file.fileName();
+    return;
+  }
+  QJsonObject stats = renderStatistics();
+  stats.insert("time", QDateTime::currentDateTime().toString(Qt::ISODate));
+  file.write(QJsonDocument(stats).toJson(QJsonDocument::Compact));
+  file.write("\n");
+}
+
 bool Master::saveBpr(const QString &filename)
 {
+  // Finish the previous save first, such that files are written in order.
+  finishSave();
   // Save elements and attributes specific to BeamerPresenter
   // only if file name does not end with ".xopp".
   const bool save_bp_specific =
       !filename.endsWith(".xopp", Qt::CaseInsensitive);
-  QBuffer buffer;
-  buffer.open(QBuffer::WriteOnly);
-  if (!writeXml(buffer, save_bp_specific)) return false;
-
-  // Write to gzipped file.
-  if (!filename.endsWith(".xml")) {
-    gzFile zfile = gzopen(filename.toUtf8(), "wb");
-    if (zfile) {
-      gzwrite(zfile, buffer.data().data(), buffer.data().length());
-      gzclose_w(zfile);
-      qInfo() << "Saved gzip-compressed XML to" << filename;
-      master_file = filename;
-      return true;
-    }
-  }
-  QFile file(filename);
-  if (file.open(QFile::WriteOnly)) {
-    if (filename.endsWith(".xml"))
-      qInfo() << "Saving uncompressed XML to" << filename;
-    else
-      qWarning() << "Compressing document failed. Saving uncompressed XML to"
-                 << filename;
-    file.write(buffer.data());
-    file.close();
-  } else {
-    preferences()->showErrorMessage(
-        tr("Error while saving file"),
-        tr("Saving document failed for file path: ") + filename);
+  BprWriter *writer = new BprWriter(filename, this);
+  if (!writeXmlHead(writer->xml(), save_bp_specific)) {
+    delete writer;
     return false;
   }
+  // Snapshots of the drawings are cheap. Serializing and compressing them
+  // is done in the background.
+  for (const auto &pdf : std::as_const(documents))
+    writer->addPages(pdf->snapshotPages(save_bp_specific));
+  // Use writer as context, such that results are dropped if writer is
+  // deleted before they are received. In this case finishSave() reports
+  // the result.
+  connect(writer, &BprWriter::finished, writer,
+          [this, writer, filename](const bool success) {
+            if (bpr_writer == writer) bpr_writer = nullptr;
+            if (!success) saveFailed(filename);
+            writer->deleteLater();
+          });
+  bpr_writer = writer;
   master_file = filename;
+  writer->start();
   return true;
 }
 
-bool Master::writeXml(QBuffer &buffer, const bool save_bp_specific)
+bool Master::finishSave()
+{
+  BprWriter *writer = bpr_writer;
+  bpr_writer = nullptr;
+  if (!writer) return true;
+  const bool success = writer->finish();
+  if (!success) saveFailed(writer->getFilename());
+  delete writer;
+  return success;
+}
+
+void Master::saveFailed(const QString &filename)
+{
+  // The flags were cleared when the snapshots were taken.
+  for (const auto &pdf : std::as_const(documents)) {
+    pdf->flags() |= PdfMaster::UnsavedDrawings;
+    if (!filename.endsWith(".xopp", Qt::CaseInsensitive))
+      pdf->flags() |= PdfMaster::UnsavedTimes;
+  }
+  preferences()->showErrorMessage(
+      tr("Error while saving file"),
+      tr("Saving document failed for file path: ") + filename);
+}
+
+bool Master::writeXmlHead(QXmlStreamWriter &writer,
+                          const bool save_bp_specific)
 {
-  QXmlStreamWriter writer(&buffer);
   writer.setAutoFormatting(true);
   writer.setAutoFormattingIndent(0);
   writer.writeStartDocument();
@@ -1248,11 +1395,7 @@ bool Master::writeXml(QBuffer &buffer, const bool save_bp_specific)
     writer.writeEndElement();  // "beamerpresenter" element
   }
 
-  for (const auto &pdf : std::as_const(documents))
-    pdf->writePages(writer, save_bp_specific);
-
-  writer.writeEndElement();  // "xournal" element
-  writer.writeEndDocument();
+  // The pages and the end of the document are written by BprWriter.
   if (writer.hasError()) {
     preferences()->showErrorMessage(
         tr("Error while saving bpr/xopp file"),
@@ -1380,6 +1523,7 @@ bool Master::loadXmlDrawings(QBuffer *buffer, const bool clear_drawings,
     } else if (!reader.isEndElement())
       reader.skipCurrentElement();
   }
+  emit slideOrderChanged(page_idx);
   if (reader.hasError())
     preferences()->showErrorMessage(
         tr("Error while loading file"),
@@ -10,6 +10,7 @@
 #include <QMap>
 #include <QObject>
 #include <QPainter>
+#include <QPointer>
 #include <QRectF>
 #include <QRegularExpression>
 #include <memory>
@@ -28,6 +29,8 @@ class QString;
 class QJsonObject;
 class QWidget;
 class QKeyEvent;
+class BatchExport;
+class BprWriter;
 class PdfMaster;
 class SlideScene;
 class SlideView;
@@ -69,6 +72,9 @@ class Master : public QObject
   /// File name of file containing drawings etc.
   QString master_file;
 
+  /// Most recent save, nullptr if it is finished.
+  QPointer<BprWriter> bpr_writer;
+
   /// Map of cache hashs to cache objects.
   QMap<int, const PixCache *> caches;
 
@@ -85,6 +91,12 @@ class Master : public QObject
   /// Timer for automatic slide changes.
   int slideDurationTimer_id{-1};
 
+  /// Timer for writing statistics to preferences()->statistics_file.
+  int statisticsTimer_id{-1};
+
+  /// Append current statistics to preferences()->statistics_file.
+  void writeStatistics() const;
+
   /// Ask for confirmation when closing.
   /// Return true when the program should quit.
   bool askCloseConfirmation() noexcept;
@@ -143,7 +155,8 @@ class Master : public QObject
   /// Read configuration file and build up GUI.
   Status readGuiConfig(const QString &filename);
 
-  /// Calculate total cache size (sum up cache sizes from all PixCache objects).
+  /// Calculate total cache size (sum up sizes of compressed and decoded
+  /// pages from all PixCache objects).
   qint64 getTotalCache() const;
 
   /**
@@ -173,6 +186,10 @@ class Master : public QObject
   /// List containing page index for each slide.
   const QList<int> &pageIdx() const noexcept { return page_idx; }
 
+  /// Cache and rendering statistics of all documents as JSON object.
+  /// @see RenderStats
+  QJsonObject renderStatistics() const;
+
   /// Next empty page, allowed to exist in history.
   int nextEmptyPage() const noexcept
   {
@@ -190,17 +207,29 @@ class Master : public QObject
     return page_to_slide.contains(page);
   }
 
+  /// Create a batch export of all pages of the presentation including
+  /// drawings to target, which should be a PDF file or a PNG file name.
+  /// The returned job is not started yet and deletes itself when it is
+  /// finished. Return nullptr if no document is loaded.
+  BatchExport *exportPages(const QString &target);
+
   /// Get save file name from QFileDialog
   static QString getSaveFileName();
   /// Get open file name from QFileDialog
   static QString getOpenFileName();
 
-  /// Save gzipped XML file.
-  /// Return true if file was written successfully.
+  /// Save gzipped XML file in the background.
+  /// Return false if saving could not be started.
   bool saveBpr(const QString &filename);
-  /// Write XML to stream.
-  /// Return true if saving was successful.
-  bool writeXml(QBuffer &buffer, const bool save_bp_specific);
+  /// Complete the latest save started by saveBpr() and report its result
+  /// directly. Return false if saving failed.
+  bool finishSave();
+  /// Show an error message and mark the documents as unsaved again after
+  /// saving to filename failed.
+  void saveFailed(const QString &filename);
+  /// Write beginning of XML document up to the pages.
+  /// Return true if writing was successful.
+  bool writeXmlHead(QXmlStreamWriter &writer, const bool save_bp_specific);
 
   /// Load bpr or xopp file: Only initialize PDF documents, don't load drawings.
   bool loadBprInit(const QString &filename);
@@ -228,7 +257,7 @@ class Master : public QObject
   void loadPdfpcJSON(const QString &filename);
 
  protected:
-  /// Timeout event: cache videos or change slide
+  /// Timeout event: cache videos, change slide or write statistics
   void timerEvent(QTimerEvent *event) override;
 
   /// Filter key input events from other widgets
@@ -287,6 +316,9 @@ class Master : public QObject
   void sendScaledMemory(const float scale);
   /// Clear cache of all PixCache objects
   void clearCache();
+  /// Remove changed pages of the reloaded document at path from all
+  /// PixCache objects.
+  void invalidatePages(const QString &path, const QList<int> &pages);
   /// Tell slide scenes to start post-rendering operations.
   void postRendering();
 
@@ -298,6 +330,17 @@ class Master : public QObject
   /// This should only be used in queued connection.
   void navigationSignal(const int slide, const int page);
 
+  /// Page index for each slide has changed.
+  void slideOrderChanged(const QList<int> &page_idx);
+
+  /// Forwarded from PdfMaster::searchHitsCleared.
+  void searchHitsCleared();
+  /// Forwarded from PdfMaster::searchHit.
+  void searchHit(const int page, const int count, const QList<QRectF> &results,
+                 const QString &snippet);
+  /// Forwarded from PdfMaster::searchAllFinished.
+  void searchAllFinished(const int hits);
+
   /// Set end time (in ms) for page.
   void setTimeForPage(const int page, const quint32 time);
   /// Get end time (in ms) for page. time is set to UINT32_MAX if no end time is
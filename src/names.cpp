@@ -31,6 +31,7 @@ GuiWidget string_to_widget_type(const QString &string) noexcept
       {"timer", TimerType},
       {"slide number", SlideNumberType},
       {"slide label", SlideLabelType},
+      {"cache statistics", StatisticsType},
   };
   const auto find = lookup_table.find(string.toLower().toStdString());
   if (find == lookup_table.end()) return InvalidType;
@@ -84,6 +85,7 @@ const QMap<QString, Action> &get_string_to_action() noexcept
       {QT_TRANSLATE_NOOP("SettingsWidget", "save"), SaveDrawings},
       {QT_TRANSLATE_NOOP("SettingsWidget", "save as"), SaveDrawingsAs},
       {QT_TRANSLATE_NOOP("SettingsWidget", "export svg"), ExportDrawingsSvg},
+      {QT_TRANSLATE_NOOP("SettingsWidget", "export pages"), ExportPages},
       {QT_TRANSLATE_NOOP("SettingsWidget", "open"), LoadDrawings},
       {QT_TRANSLATE_NOOP("SettingsWidget", "open unsafe"), LoadDrawingsNoClear},
       // Modify drawn items
@@ -130,6 +132,48 @@ const QMap<QString, OverlayDrawingMode> &get_string_to_overlay_mode() noexcept
   return string_to_overlay_mode;
 }
 
+const QMap<QString, CacheCodec> &get_string_to_cache_codec() noexcept
+{
+  static const QMap<QString, CacheCodec> string_to_cache_codec{
+      {"png", CacheCodec::PNG},
+      {"fast", CacheCodec::Fast},
+      {"none", CacheCodec::Uncompressed},
+  };
+  return string_to_cache_codec;
+}
+
+const QString renderer_name(const Renderer renderer) noexcept
+{
+  switch (renderer) {
+#ifdef USE_QTPDF
+    case Renderer::QtPDF:
+      return "qtpdf";
+#endif
+#ifdef USE_POPPLER
+    case Renderer::Poppler:
+      return "poppler";
+#endif
+#ifdef USE_MUPDF
+    case Renderer::MuPDF:
+      return "mupdf";
+#endif
+#ifdef USE_EXTERNAL_RENDERER
+    case Renderer::ExternalRenderer:
+      return "external";
+#endif
+  }
+  return QString();
+}
+
+const QMap<QString, PrefetchMode> &get_string_to_prefetch_mode() noexcept
+{
+  static const QMap<QString, PrefetchMode> string_to_prefetch_mode{
+      {"linear", PrefetchMode::Linear},
+      {"navigation", PrefetchMode::Navigation},
+  };
+  return string_to_prefetch_mode;
+}
+
 const QMap<PagePart, QString> &get_page_part_names() noexcept
 {
   static const QMap<PagePart, QString> page_part_names{
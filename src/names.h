@@ -23,6 +23,17 @@ Gesture string_to_gesture(const QString &string) noexcept;
 /// @see PdfMaster
 const QMap<QString, OverlayDrawingMode> &get_string_to_overlay_mode() noexcept;
 
+/// Map human readable string to cache codec.
+/// @see PngPixmap
+const QMap<QString, CacheCodec> &get_string_to_cache_codec() noexcept;
+
+/// Short human readable name of renderer.
+const QString renderer_name(const Renderer renderer) noexcept;
+
+/// Map human readable string to prefetch mode.
+/// @see PrefetchPolicy
+const QMap<QString, PrefetchMode> &get_string_to_prefetch_mode() noexcept;
+
 const QMap<PagePart, QString> &get_page_part_names() noexcept;
 
 #ifdef QT_DEBUG
@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/navigationbenchmark.h"
+
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QTimerEvent>
+#include <algorithm>
+#include <cmath>
+
+#include "src/log.h"
+#include "src/master.h"
+#include "src/preferences.h"
+
+NavigationBenchmark::NavigationBenchmark(const QStringList &sequences,
+                                         QObject *parent)
+    : QObject(parent), sequence_names(sequences)
+{
+}
+
+NavigationBenchmark::~NavigationBenchmark()
+{
+  if (running == this) running = nullptr;
+}
+
+QList<int> NavigationBenchmark::createSequence(const QString &name,
+                                               const int slides)
+{
+  QList<int> list;
+  if (slides < 2) return list;
+  if (name == "sequential") {
+    // All slides in order, starting from the second slide.
+    for (int slide = 1; slide < slides; ++slide) list.append(slide);
+  } else if (name == "random") {
+    // Random jumps with a fixed seed for reproducible results.
+    QRandomGenerator generator(42);
+    int last = 0;
+    for (int i = 0; i < random_steps; ++i) {
+      int slide = generator.bounded(slides - 1);
+      // Never navigate to the slide which is already shown.
+      if (slide >= last) ++slide;
+      list.append(slide);
+      last = slide;
+    }
+  } else if (name == "overlays") {
+    // Go forward, back and forward again, as when repeating an overlay.
+    for (int slide = 1; slide < slides; ++slide)
+      list << slide << slide - 1 << slide;
+  }
+  return list;
+}
+
+QJsonObject NavigationBenchmark::summary(std::vector<float> &samples)
+{
+  if (samples.empty()) return {{"count", 0}};
+  std::sort(samples.begin(), samples.end());
+  const auto percentile = [&samples](const double p) -> double {
+    const size_t index = std::min<size_t>(
+        samples.size() - 1, std::ceil(p * samples.size()) - 1);
+    return samples[index];
+  };
+  double sum = 0.;
+  for (const float value : samples) sum += value;
+  return {
+      {"count", static_cast<qint64>(samples.size())},
+      {"mean", sum / samples.size()},
+      {"p50", percentile(0.5)},
+      {"p90", percentile(0.9)},
+      {"p99", percentile(0.99)},
+      {"max", samples.back()},
+  };
+}
+
+void NavigationBenchmark::start()
+{
+  running = this;
+  sequence_index = -1;
+  finishSequence();
+}
+
+void NavigationBenchmark::nextStep()
+{
+  if (running != this) return;
+  ++step_index;
+  if (step_index >= sequence.length()) {
+    finishSequence();
+    return;
+  }
+  current.fill(-1.f);
+  timeout_timer = startTimer(timeout_ms);
+  timer.start();
+  master()->navigateToSlide(sequence[step_index]);
+}
+
+void NavigationBenchmark::recordStage(const Stage stage)
+{
+  if (!timer.isValid() || current[stage] >= 0) return;
+  // Painting only counts after the page is ready.
+  if (stage == PagePainted && current[PageReady] < 0) return;
+  current[stage] = timer.nsecsElapsed() / 1e6f;
+  if (stage == PagePainted) finishStep();
+}
+
+void NavigationBenchmark::finishStep()
+{
+  timer.invalidate();
+  if (timeout_timer != -1) killTimer(timeout_timer);
+  timeout_timer = -1;
+  bool complete = true;
+  for (int stage = 0; stage < NumberOfStages; ++stage) {
+    if (current[stage] >= 0)
+      samples[stage].push_back(current[stage]);
+    else
+      complete = false;
+  }
+  if (!complete) ++timeouts;
+  QTimer::singleShot(dwell_ms, this, &NavigationBenchmark::nextStep);
+}
+
+void NavigationBenchmark::finishSequence()
+{
+  if (sequence_index >= 0 && sequence_index < sequence_names.length())
+    results.insert(sequence_names[sequence_index],
+                   QJsonObject{
+                       {"steps", sequence.length()},
+                       {"timeouts", timeouts},
+                       {"navigation ms", summary(samples[SceneNavigated])},
+                       {"page ready ms", summary(samples[PageReady])},
+                       {"first paint ms", summary(samples[PagePainted])},
+                   });
+  for (auto &list : samples) list.clear();
+  timeouts = 0;
+  step_index = -1;
+  ++sequence_index;
+  if (sequence_index >= sequence_names.length()) {
+    running = nullptr;
+    emit finished();
+    return;
+  }
+  sequence = createSequence(sequence_names[sequence_index],
+                            master()->pageIdx().length());
+  if (sequence.isEmpty())
+    qWarning() << "Invalid or empty navigation sequence:"
+               << sequence_names[sequence_index];
+  debug_msg(DebugPageChange, "starting navigation benchmark"
+                                 << sequence_names[sequence_index]
+                                 << sequence.length());
+  // Start each sequence from the first slide.
+  master()->navigateToSlide(0);
+  QTimer::singleShot(dwell_ms, this, &NavigationBenchmark::nextStep);
+}
+
+void NavigationBenchmark::timerEvent(QTimerEvent *event)
+{
+  killTimer(event->timerId());
+  if (event->timerId() != timeout_timer) return;
+  timeout_timer = -1;
+  qWarning() << "Navigation to slide" << sequence.value(step_index)
+             << "timed out";
+  finishStep();
+}
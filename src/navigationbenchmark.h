@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef NAVIGATIONBENCHMARK_H
+#define NAVIGATIONBENCHMARK_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+#include <array>
+#include <vector>
+
+#include "src/config.h"
+
+/**
+ * @brief Measure the latency of navigation in the running application.
+ *
+ * The benchmark navigates through a scripted sequence of slides using
+ * Master::navigateToSlide and measures the time until the scenes navigate
+ * (SlideScene::navigationEvent), until a view receives the rendered page
+ * (SlideView::pageReady) and until this page is painted for the first time.
+ * After each step the benchmark waits for a short time before the next
+ * navigation, such that background rendering can continue as in a real
+ * presentation.
+ *
+ * Only one benchmark can run at a time. The views and scenes report events
+ * using the static function record(), which does nothing if no benchmark is
+ * running.
+ */
+class NavigationBenchmark : public QObject
+{
+  Q_OBJECT
+
+ public:
+  /// Measured events after navigation.
+  enum Stage {
+    SceneNavigated = 0,  ///< SlideScene::navigationEvent
+    PageReady,           ///< SlideView::pageReady
+    PagePainted,         ///< first paint after the page was ready
+    NumberOfStages,
+  };
+
+ private:
+  /// Time waited after each step before the next navigation in ms.
+  static constexpr int dwell_ms = 200;
+
+  /// Maximum time waiting for a page to be painted in ms.
+  static constexpr int timeout_ms = 10000;
+
+  /// Maximum number of steps of the random sequence.
+  static constexpr int random_steps = 100;
+
+  /// Running benchmark, nullptr if no benchmark is running.
+  inline static NavigationBenchmark *running = nullptr;
+
+  /// Names of the sequences.
+  QStringList sequence_names;
+
+  /// Slides of the current sequence.
+  QList<int> sequence;
+
+  /// Index of the current sequence in sequence_names.
+  int sequence_index = -1;
+
+  /// Index of the current step in sequence.
+  int step_index = -1;
+
+  /// Started when navigating.
+  QElapsedTimer timer;
+
+  /// Time of each stage in the current step, negative if not reached yet.
+  std::array<float, NumberOfStages> current{};
+
+  /// Measured times of each stage in the current sequence.
+  std::array<std::vector<float>, NumberOfStages> samples;
+
+  /// Number of steps in current sequence which did not reach all stages.
+  int timeouts = 0;
+
+  /// Timer id of the timeout of the current step.
+  int timeout_timer = -1;
+
+  /// Results of completed sequences.
+  QJsonObject results;
+
+  /// Create the slides of the named sequence for given number of slides.
+  static QList<int> createSequence(const QString &name, const int slides);
+
+  /// Percentiles, mean and maximum of samples as JSON object.
+  static QJsonObject summary(std::vector<float> &samples);
+
+  /// Store the times of the current step.
+  void finishStep();
+
+  /// Store the results of the current sequence.
+  void finishSequence();
+
+  /// Record stage of the current step.
+  void recordStage(const Stage stage);
+
+ public:
+  /// Constructor: sequences is a list of sequence names, which may be
+  /// "sequential", "random" or "overlays".
+  explicit NavigationBenchmark(const QStringList &sequences,
+                               QObject *parent = nullptr);
+
+  /// Destructor: unregister.
+  ~NavigationBenchmark();
+
+  /// Report that stage has been reached in the running benchmark.
+  static void record(const Stage stage)
+  {
+    if (running) running->recordStage(stage);
+  }
+
+  /// Results of all completed sequences.
+  const QJsonObject &getResults() const noexcept { return results; }
+
+ protected:
+  /// Timeout event: the current step took too long.
+  void timerEvent(QTimerEvent *event) override;
+
+ public slots:
+  /// Start the benchmark.
+  void start();
+
+  /// Navigate to the next slide in the sequence.
+  void nextStep();
+
+ signals:
+  /// All sequences are finished.
+  void finished();
+};
+
+#endif  // NAVIGATIONBENCHMARK_H
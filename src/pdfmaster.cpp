@@ -28,6 +28,7 @@
 #include "src/preferences.h"
 #include "src/rendering/abstractrenderer.h"
 #include "src/rendering/pdfdocument.h"
+#include "src/rendering/textindex.h"
 #include "src/slidescene.h"
 #ifdef USE_QTPDF
 #include "src/rendering/qtdocument.h"
@@ -41,6 +42,8 @@
 
 PdfMaster::~PdfMaster()
 {
+  // Stop searching and indexing while this object is still valid.
+  delete text_index;
   qDeleteAll(paths);
   paths.clear();
 }
@@ -55,6 +58,7 @@ bool PdfMaster::loadDocument(const QString &filename)
                                          "different file is already loaded!"));
     else if (document->loadDocument()) {
       document->loadLabels();
+      createTextIndex();
       return true;
     }
     return false;
@@ -85,6 +89,7 @@ bool PdfMaster::loadDocument(const QString &filename)
     return false;
   } else {
     document->loadLabels();
+    createTextIndex();
     return true;
   }
 }
@@ -93,11 +98,28 @@ bool PdfMaster::loadDocument()
 {
   if (document && document->loadDocument()) {
     document->loadLabels();
+    createTextIndex();
     return true;
   }
   return false;
 }
 
+void PdfMaster::createTextIndex()
+{
+  // The text of a reloaded document may have changed.
+  if (text_index) emit searchHitsCleared();
+  delete text_index;
+  text_index = nullptr;
+  if (!document || !document->hasPageText()) return;
+  text_index = new TextIndex(document, this);
+  connect(text_index, &TextIndex::searchFinished, this,
+          &PdfMaster::showSearchResults);
+  connect(text_index, &TextIndex::pageMatches, this, &PdfMaster::searchHit);
+  connect(text_index, &TextIndex::searchAllFinished, this,
+          &PdfMaster::searchAllFinished);
+  text_index->start();
+}
+
 SlideScene *PdfMaster::getActiveScene(const PPage ppage) const
 {
   for (auto scene : scenes) {
@@ -262,9 +284,10 @@ void PdfMaster::distributeNavigationEvents(const int slide,
   for (const auto scene : std::as_const(scenes)) scene->createSliders();
 }
 
-void PdfMaster::writePages(QXmlStreamWriter &writer,
-                           const bool save_bp_specific)
+QList<PdfMaster::PageSnapshot> PdfMaster::snapshotPages(
+    const bool save_bp_specific)
 {
+  QList<PageSnapshot> snapshots;
   QMap<PagePart, const PathContainer *> container_lst;
   QSizeF size;
   for (auto page : master()->pageIdx()) {
@@ -282,38 +305,53 @@ void PdfMaster::writePages(QXmlStreamWriter &writer,
         drawing_rect = drawing_rect.united(container->boundingBox());
       size = drawing_rect.size();
     }
-    writer.writeStartElement("page");
-    writer.writeAttribute("width", QString::number(size.width()));
-    writer.writeAttribute("height", QString::number(size.height()));
-    writer.writeEmptyElement("background");
+    PageSnapshot snapshot;
+    snapshot.attributes.append("width", QString::number(size.width()));
+    snapshot.attributes.append("height", QString::number(size.height()));
+    QXmlStreamAttributes &background = snapshot.background;
     if (page >= 0) {
-      writer.writeAttribute("type", "pdf");
-      writer.writeAttribute("pageno", QString::number(page + 1));
+      background.append("type", "pdf");
+      background.append("pageno", QString::number(page + 1));
       if (page == 0) {
-        writer.writeAttribute("domain", "absolute");
-        writer.writeAttribute("filename", document->getPath());
+        background.append("domain", "absolute");
+        background.append("filename", document->getPath());
       }
     } else {
-      writer.writeAttribute("type", "solid");
-      writer.writeAttribute("style", "plain");
-      writer.writeAttribute("color", "#ffffff00");
+      background.append("type", "solid");
+      background.append("style", "plain");
+      background.append("color", "#ffffff00");
     }
     if (save_bp_specific && target_times.contains(page))
-      writer.writeAttribute("endtime",
-                            QTime::fromMSecsSinceStartOfDay(target_times[page])
-                                .toString("h:mm:ss"));
+      background.append("endtime",
+                        QTime::fromMSecsSinceStartOfDay(target_times[page])
+                            .toString("h:mm:ss"));
+    for (auto it = container_lst.cbegin(); it != container_lst.cend(); ++it)
+      snapshot.layers.append(
+          {get_page_part_names().value(it.key(), "unknown"),
+           (*it)->snapshot()});
+    snapshots.append(snapshot);
+  }
+  _flags &= ~UnsavedDrawings;
+  if (save_bp_specific) _flags &= ~UnsavedTimes;
+  return snapshots;
+}
 
-    for (auto it = container_lst.cbegin(); it != container_lst.cend(); ++it) {
+void PdfMaster::writePages(QXmlStreamWriter &writer,
+                           const QList<PageSnapshot> &pages)
+{
+  for (const auto &page : pages) {
+    writer.writeStartElement("page");
+    writer.writeAttributes(page.attributes);
+    writer.writeEmptyElement("background");
+    writer.writeAttributes(page.background);
+    for (const auto &[page_part, elements] : page.layers) {
       writer.writeStartElement("layer");
-      writer.writeAttribute("pagePart",
-                            get_page_part_names().value(it.key(), "unknown"));
-      (*it)->writeXml(writer);
+      writer.writeAttribute("pagePart", page_part);
+      PathContainer::writeXml(writer, elements);
       writer.writeEndElement();  // "layer" element
     }
     writer.writeEndElement();  // "page" element
   }
-  _flags &= ~UnsavedDrawings;
-  if (save_bp_specific) _flags &= ~UnsavedTimes;
 }
 
 QBuffer *loadZipToBuffer(const QString &filename)
@@ -439,11 +477,33 @@ void PdfMaster::search(const QString &text, const int &page, const bool forward)
 {
   if (!document || page < 0) return;
   if (text == "") {
+    if (text_index) text_index->cancelSearch();
     search_results.second.clear();
     emit updateSearch();
     return;
   }
-  search_results = document->searchAll(text, page, forward);
+  if (text_index) {
+    // Results are sent to showSearchResults.
+    text_index->search(text, page, forward);
+  } else {
+    const auto [result_page, results] =
+        document->searchAll(text, page, forward);
+    showSearchResults(result_page, results);
+  }
+}
+
+void PdfMaster::searchAllPages(const QString &text)
+{
+  emit searchHitsCleared();
+  if (text_index)
+    text_index->searchAllPages(text);
+  else
+    emit searchAllFinished(0);
+}
+
+void PdfMaster::showSearchResults(const int page, const QList<QRectF> &results)
+{
+  search_results = {page, results};
   if (search_results.first == preferences()->page)
     emit updateSearch();
   else if (search_results.first >= 0)
@@ -482,6 +542,23 @@ QPixmap PdfMaster::exportImage(const PPage ppage,
   return pixmap;
 }
 
+QPicture PdfMaster::drawingsPicture(const PPage ppage) const
+{
+  QPicture picture;
+  const auto *container = pathContainer(ppage);
+  if (!container) return picture;
+  QStyleOptionGraphicsItem style;
+  QPainter painter;
+  painter.begin(&picture);
+  for (auto item : *container) {
+    painter.resetTransform();
+    painter.setTransform(item->sceneTransform());
+    item->paint(&painter, &style);
+  }
+  painter.end();
+  return picture;
+}
+
 int PdfMaster::overlaysShiftedSlide(int slide,
                                     const PageShift shift_overlay) const
 {
@@ -7,8 +7,10 @@
 #include <QList>
 #include <QMap>
 #include <QObject>
+#include <QPicture>
 #include <QRectF>
 #include <QString>
+#include <QXmlStreamAttributes>
 #include <algorithm>
 #include <map>
 #include <memory>
@@ -26,6 +28,7 @@ class QXmlStreamReader;
 class QXmlStreamWriter;
 class AbstractGraphicsPath;
 class TextGraphicsItem;
+class TextIndex;
 struct SlideTransition;
 
 namespace drawHistory
@@ -84,6 +87,13 @@ class PdfMaster : public QObject
   /// Search results (currently only one results)
   std::pair<int, QList<QRectF>> search_results;
 
+  /// Full-text index used for searching, nullptr if the PDF engine does not
+  /// support text extraction.
+  TextIndex *text_index = nullptr;
+
+  /// Create a new text index for document and start indexing.
+  void createTextIndex();
+
   /// make sure paths[page] is a PathContainer*
   void assertPageExists(const PPage ppage) noexcept
   {
@@ -189,6 +199,11 @@ class PdfMaster : public QObject
   /// Write page (part) to image, including drawings.
   QPixmap exportImage(const PPage ppage, const qreal resolution) const noexcept;
 
+  /// Record drawings on page (part) as picture in scene coordinates. This
+  /// must be called in the main thread, but the picture may be painted in
+  /// other threads.
+  QPicture drawingsPicture(const PPage ppage) const;
+
   /// Export annotations to a page as SVG image.
   void exportSvg(const PPage page, const QString filename) const;
 
@@ -230,8 +245,24 @@ class PdfMaster : public QObject
   /// Check if page currently contains any drawings (ignoring history).
   bool hasDrawings() const noexcept;
 
-  /// Write pages objects to XML
-  void writePages(QXmlStreamWriter &writer, const bool save_bp_specific);
+  /// Snapshot of the drawings of a page, which can be written to XML in any
+  /// thread.
+  struct PageSnapshot {
+    /// Attributes of the page element.
+    QXmlStreamAttributes attributes;
+    /// Attributes of the background element.
+    QXmlStreamAttributes background;
+    /// Page part name and elements of each layer.
+    QList<std::pair<QString, QList<PathContainer::ElementSnapshot>>> layers;
+  };
+
+  /// Create snapshots of all pages for saving. This marks drawings (and
+  /// times if save_bp_specific is true) as saved.
+  QList<PageSnapshot> snapshotPages(const bool save_bp_specific);
+
+  /// Write page snapshots to XML. This can be used in any thread.
+  static void writePages(QXmlStreamWriter &writer,
+                         const QList<PageSnapshot> &pages);
 
  public slots:
   /// Handle the given action.
@@ -311,6 +342,12 @@ class PdfMaster : public QObject
   /// Handle the given action.
   void search(const QString &text, const int &page, const bool forward);
 
+  /// Search text in all pages. Results are sent by searchHit.
+  void searchAllPages(const QString &text);
+
+  /// Show search results on page and navigate there if necessary.
+  void showSearchResults(const int page, const QList<QRectF> &results);
+
   /// change drawings_path.
   void setDrawingsPath(const QString &filename) noexcept
   {
@@ -328,6 +365,13 @@ class PdfMaster : public QObject
   void sendPage(const int page);
   /// Tell slides to update search results.
   void updateSearch();
+  /// Search results of all pages became invalid.
+  void searchHitsCleared();
+  /// Text was found count times on page, see TextIndex::pageMatches.
+  void searchHit(const int page, const int count, const QList<QRectF> &results,
+                 const QString &snippet);
+  /// Search in all pages finished with given total number of matches.
+  void searchAllFinished(const int hits);
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(PdfMaster::PdfMasterFlags);
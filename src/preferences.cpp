@@ -387,6 +387,45 @@ void Preferences::loadSettings()
   // maximum image size
   const qreal maximgsize = settings.value("max image size").toReal(&ok);
   if (ok) max_image_size = maximgsize;
+  // tiles for enlarged pages
+  const int tilesize = settings.value("tile size").toInt(&ok);
+  if (ok) tile_size = tilesize;
+  const int ntiles = settings.value("cached tiles").toInt(&ok);
+  if (ok) max_tiles = ntiles;
+  // relative resolution of previews
+  const qreal preview = settings.value("preview resolution").toReal(&ok);
+  if (ok && preview <= 1.) preview_resolution = preview;
+  // number of threads for rendering in the background
+  const int nthreads = settings.value("rendering threads").toInt(&ok);
+  if (ok) rendering_threads = nthreads;
+#ifdef USE_MUPDF
+  const int nlists = settings.value("display lists").toInt(&ok);
+  if (ok) max_display_lists = nlists;
+  const int nloaded = settings.value("loaded pages").toInt(&ok);
+  if (ok) max_loaded_pages = nloaded;
+#endif
+  // compression of cached pages
+  if (settings.contains("cache compression")) {
+    const CacheCodec codec = get_string_to_cache_codec().value(
+        settings.value("cache compression").toString().toLower(),
+        CacheCodec::InvalidCodec);
+    if (codec == CacheCodec::InvalidCodec)
+      qWarning() << "Invalid cache compression in settings:"
+                 << settings.value("cache compression");
+    else
+      cache_codec = codec;
+  }
+  // choice of pages rendered to cache
+  if (settings.contains("prefetch")) {
+    const PrefetchMode mode = get_string_to_prefetch_mode().value(
+        settings.value("prefetch").toString().toLower(),
+        PrefetchMode::InvalidPrefetch);
+    if (mode == PrefetchMode::InvalidPrefetch)
+      qWarning() << "Invalid prefetch mode in settings:"
+                 << settings.value("prefetch");
+    else
+      prefetch_mode = mode;
+  }
   {  // renderer
 #ifdef USE_EXTERNAL_RENDERER
     rendering_command = settings.value("rendering command").toString();
@@ -441,6 +480,21 @@ void Preferences::loadSettings()
   if (ok) max_memory = memory;
   const int npages = settings.value("cache pages").toInt(&ok);
   if (ok) max_cache_pages = npages;
+  const int ndecoded = settings.value("decoded pages").toInt(&ok);
+  if (ok) max_decoded_pages = ndecoded;
+  const qint64 disk_size = settings.value("disk cache size").toLongLong(&ok);
+  if (ok) disk_cache_size = disk_size;
+  if (settings.value("mapped cache", false).toBool())
+    global_flags |= MappedCache;
+  else
+    global_flags &= ~MappedCache;
+  // statistics
+  statistics_file = settings.value("statistics file").toString();
+  const int interval = settings.value("statistics interval").toInt(&ok);
+  if (ok && interval > 0) statistics_interval = interval;
+  // export
+  const qreal dpi = settings.value("export dpi").toReal(&ok);
+  if (ok && dpi > 0) export_dpi = dpi;
 
   // INTERACTION
   // Default tools associated to devices
@@ -651,6 +705,10 @@ void Preferences::loadFromParser(const QCommandLineParser &parser)
   // disable cache
   if (parser.isSet("nocache")) max_cache_pages = 0;
 
+  // write statistics
+  if (parser.isSet("statistics"))
+    statistics_file = parser.value("statistics");
+
 #ifdef QT_DEBUG
   // (Re)load debug info from command line.
   if (settings.contains("debug")) loadDebugFromParser(parser);
@@ -706,6 +764,49 @@ void Preferences::setCacheSize(const int new_size)
   emit distributeMemory();
 }
 
+void Preferences::setCacheCodec(const QString &string)
+{
+  const CacheCodec codec =
+      get_string_to_cache_codec().value(string, CacheCodec::InvalidCodec);
+  if (codec == CacheCodec::InvalidCodec) return;
+  cache_codec = codec;
+  settings.beginGroup("rendering");
+  settings.setValue("cache compression", string);
+  settings.endGroup();
+}
+
+void Preferences::setPrefetchMode(const QString &string)
+{
+  const PrefetchMode mode = get_string_to_prefetch_mode().value(
+      string, PrefetchMode::InvalidPrefetch);
+  if (mode == PrefetchMode::InvalidPrefetch) return;
+  prefetch_mode = mode;
+  settings.beginGroup("rendering");
+  settings.setValue("prefetch", string);
+  settings.endGroup();
+}
+
+void Preferences::setDecodedPages(const int new_size)
+{
+  max_decoded_pages = new_size;
+  settings.setValue("decoded pages", QString::number(max_decoded_pages));
+}
+
+void Preferences::setDiskCacheSize(const int new_size)
+{
+  disk_cache_size = qint64(1048576) * new_size;
+  settings.setValue("disk cache size", QString::number(disk_cache_size));
+}
+
+void Preferences::setMappedCache(const bool enable)
+{
+  if (enable)
+    global_flags |= MappedCache;
+  else
+    global_flags &= ~MappedCache;
+  settings.setValue("mapped cache", enable);
+}
+
 void Preferences::setRenderer(const QString &string)
 {
   const QString &new_renderer = string.toLower();
@@ -949,7 +1050,8 @@ void Preferences::showErrorMessage(const QString &title,
                                    const QString &text) const
 {
   qCritical() << text;
-  master->showErrorMessage(title, text);
+  // master is not available in beamerpresenter-bench.
+  if (master) master->showErrorMessage(title, text);
 }
 
 bool Preferences::setGuiConfigFile(const QString &file)
@@ -38,7 +38,7 @@ class Preferences : public QObject
   /// that one does not exist.
   QSettings settings;
   /// Master object
-  Master *master;
+  Master *master = nullptr;
 
   friend Master *master() noexcept;
   friend int main(int argc, char *argv[]);
@@ -55,6 +55,8 @@ class Preferences : public QObject
     OpenExternalLinks = 1 << 3,
     /// Finalize drawing paths
     FinalizeDrawnPaths = 1 << 4,
+    /// Keep compressed pages in a memory mapped temporary file.
+    MappedCache = 1 << 5,
   };
   Q_DECLARE_FLAGS(GlobalFlags, GlobalFlag);
   Q_FLAG(GlobalFlags);
@@ -136,6 +138,14 @@ class Preferences : public QObject
   PagePart default_page_part = FullPage;
   /// Maximum image size in pixels.
   qreal max_image_size = 3e7;
+  /// Size of tiles in pixels for rendering enlarged pages (zoom, magnifier).
+  /// Enlarged pages are rendered as a whole if this is not positive.
+  int tile_size = 512;
+  /// Maximum number of tiles kept per cache and per page item.
+  int max_tiles = 64;
+  /// Resolution of quickly rendered previews relative to the full resolution.
+  /// Previews are disabled if this is not positive.
+  qreal preview_resolution = 0.;
 
 #ifdef USE_MUPDF
   /// PDF engine (should be same as renderer except if renderer is external)
@@ -152,6 +162,17 @@ class Preferences : public QObject
   PdfEngine pdf_engine = PdfEngine::QtPDF;
   /// Renderer used to convert PDF page to image.
   Renderer renderer = Renderer::QtPDF;
+#endif
+  /// Number of threads shared by all caches for rendering in the background.
+  /// Chosen based on the number of CPU cores if not positive.
+  int rendering_threads = 0;
+#ifdef USE_MUPDF
+  /// Maximum number of display lists cached per document in MuPDF.
+  /// Negative numbers are interpreted as infinity.
+  int max_display_lists = 64;
+  /// Maximum number of pages kept loaded per document in MuPDF.
+  /// Negative numbers are interpreted as infinity.
+  int max_loaded_pages = -1;
 #endif
 #ifdef USE_EXTERNAL_RENDERER
   /// Rendering command for external renderer.
@@ -166,6 +187,22 @@ class Preferences : public QObject
   /// Maximally allowed number of pages in cache.
   /// Negative numbers are interpreted as infinity.
   int max_cache_pages = -1;
+  /// Number of pages per cache which are kept decoded for fast navigation.
+  int max_decoded_pages = 3;
+  /// Maximally allowed size of the cache directory on disk in bytes.
+  /// Pages are not cached on disk if this is not positive.
+  qint64 disk_cache_size = 0;
+  /// Compression of pages in cache.
+  CacheCodec cache_codec = CacheCodec::PNG;
+  /// File to which cache and rendering statistics are appended
+  /// periodically. Statistics are not written if this is empty.
+  QString statistics_file;
+  /// Interval for writing statistics in ms.
+  int statistics_interval = 10000;
+  /// Resolution of exported pages in dpi.
+  qreal export_dpi = 150.;
+  /// Strategy for choosing pages which are rendered to cache.
+  PrefetchMode prefetch_mode = PrefetchMode::Navigation;
 
   // INTERACTION
   /// Touch screen gestures
@@ -328,6 +365,20 @@ class Preferences : public QObject
   void setMemory(const double new_memory);
   /// Set maximal number of slides in cache.
   void setCacheSize(const int new_size);
+  /// Set number of decoded slides per cache.
+  void setDecodedPages(const int new_size);
+
+  /// Set disk cache size (in MiB).
+  void setDiskCacheSize(const int new_size);
+
+  /// Enable/disable memory mapped cache file.
+  void setMappedCache(const bool enable);
+  /// Set compression of cached pages. Allowed values are defined in
+  /// get_string_to_cache_codec: "png", "fast" and "none".
+  void setCacheCodec(const QString &string);
+  /// Set prefetch mode. Allowed values are defined in
+  /// get_string_to_prefetch_mode: "linear" and "navigation".
+  void setPrefetchMode(const QString &string);
   /// Set renderer. Allowed values are "poppler", "mupdf",
   /// "poppler + external" and "mupdf + external".
   void setRenderer(const QString &string);
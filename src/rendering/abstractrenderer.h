@@ -4,10 +4,12 @@
 #ifndef ABSTRACTRENDERER_H
 #define ABSTRACTRENDERER_H
 
+#include <QPixmap>
+#include <QRect>
+
 #include "src/config.h"
 #include "src/enumerates.h"
 
-class QPixmap;
 class PngPixmap;
 
 /// Abstract rendering class. Instances of implementing classes should be save
@@ -38,8 +40,31 @@ class AbstractRenderer
   virtual const PngPixmap *renderPng(const int page,
                                      const qreal resolution) const = 0;
 
+  /// Render the part tile of the page. tile is given in pixels relative to
+  /// the top left corner of the image of the page (part) at the given
+  /// resolution. The returned pixmap is smaller than tile at the edges of
+  /// the page. The default implementation renders the full page, which
+  /// fails for large resolutions. Tiles should only be requested if
+  /// supportsTiles() returns true.
+  virtual const QPixmap renderTile(const int page, const qreal resolution,
+                                   const QRect &tile) const
+  {
+    return renderPixmap(page, resolution).copy(tile);
+  }
+
+  /// Check whether renderTile() only renders the requested part of the page.
+  virtual bool supportsTiles() const noexcept { return false; }
+
   /// Check if renderer is valid and can in principle render pages.
   virtual bool isValid() const = 0;
+
+  /// Request that rendering, which is currently running in another thread,
+  /// stops as soon as possible. The interrupted rendering function returns
+  /// a null image. Renderers which cannot be interrupted ignore this.
+  virtual void abort() noexcept {}
+
+  /// Reset abort flag. Must be called before rendering after abort().
+  virtual void resetAbort() noexcept {}
 };
 
 #endif  // ABSTRACTRENDERER_H
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/rendering/diskcache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <vector>
+
+#include "src/log.h"
+#include "src/preferences.h"
+#include "src/rendering/pngpixmap.h"
+
+QMutex DiskCache::size_mutex;
+QMutex DiskCache::hash_mutex;
+QMap<QString, DiskCache::FileHash> DiskCache::file_hashes;
+qint64 DiskCache::total_size = -1;
+
+bool DiskCache::enabled() noexcept
+{
+  return preferences()->disk_cache_size > 0;
+}
+
+QString DiskCache::cacheRoot()
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/pages";
+}
+
+QByteArray DiskCache::fileHash(const QString &path)
+{
+  const QDateTime time = QFileInfo(path).lastModified();
+  // Keep the lock while hashing: all threads asking for the same file need
+  // the result anyway and the file should only be read once.
+  QMutexLocker locker(&hash_mutex);
+  const auto it = file_hashes.constFind(path);
+  if (it != file_hashes.cend() && it->time == time) return it->hash;
+  QFile file(path);
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  if (!file.open(QFile::ReadOnly) || !hash.addData(&file)) return {};
+  const QByteArray result = hash.result().toHex();
+  file_hashes.insert(path, {time, result});
+  debug_msg(DebugCache, "computed hash of file" << path << result);
+  return result;
+}
+
+QString DiskCache::filePath(const int page, const qreal resolution)
+{
+  const QByteArray file_hash = fileHash(pdf_path);
+  if (file_hash.isEmpty()) return QString();
+  const QString dir = cacheRoot() + "/" + QString::fromLatin1(file_hash);
+  return dir + QString("/%1-%2-%3-%4.bpc")
+                   .arg(page)
+                   .arg(page_part)
+                   // PngPixmap stores the resolution as float.
+                   .arg(static_cast<float>(resolution), 0, 'g', 6)
+                   .arg(static_cast<int>(preferences()->renderer));
+}
+
+PngPixmap *DiskCache::load(const int page, const qreal resolution)
+{
+  const QString path = filePath(page, resolution);
+  if (path.isEmpty()) return nullptr;
+  QFile file(path);
+  if (!file.open(QFile::ReadOnly)) return nullptr;
+  PngPixmap *pixmap = PngPixmap::read(&file, page, resolution);
+  // Mark the file as recently used. This requires an open file.
+  if (pixmap && !file.setFileTime(QDateTime::currentDateTime(),
+                                  QFileDevice::FileModificationTime))
+    debug_msg(DebugCache, "failed to update time of cache file" << path);
+  file.close();
+  if (pixmap) {
+    debug_verbose(DebugCache, "loaded page from disk cache" << page);
+  } else {
+    qWarning() << "Removing invalid file from disk cache:" << path;
+    file.remove();
+  }
+  return pixmap;
+}
+
+void DiskCache::store(const PngPixmap *pixmap)
+{
+  if (pixmap == nullptr || pixmap->isNull()) return;
+  const QString path = filePath(pixmap->getPage(), pixmap->getResolution());
+  if (path.isEmpty() || !QDir().mkpath(QFileInfo(path).path())) return;
+  QSaveFile file(path);
+  if (!file.open(QFile::WriteOnly) || !pixmap->write(&file) ||
+      !file.commit()) {
+    qWarning() << "Writing page to disk cache failed:" << path;
+    return;
+  }
+  debug_verbose(DebugCache, "wrote page to disk cache" << pixmap->getPage());
+  addSize(QFileInfo(path).size());
+}
+
+void DiskCache::addSize(const qint64 bytes)
+{
+  const qint64 max_size = preferences()->disk_cache_size;
+  QMutexLocker locker(&size_mutex);
+  if (total_size >= 0) {
+    total_size += bytes;
+    if (total_size <= max_size) return;
+  }
+
+  // Scan the cache directory for cached pages and text indexes.
+  std::vector<QFileInfo> files;
+  total_size = 0;
+  QDirIterator it(
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation),
+      {"*.bpc", "*.bpt"}, QDir::Files, QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    files.push_back(it.fileInfo());
+    total_size += files.back().size();
+  }
+  if (total_size <= max_size) return;
+
+  // Delete least recently used files until the cache uses at most 90% of
+  // the allowed size. This avoids scanning the directory too often.
+  std::sort(files.begin(), files.end(),
+            [](const QFileInfo &a, const QFileInfo &b) {
+              return a.lastModified() < b.lastModified();
+            });
+  for (const auto &file : files) {
+    if (10 * total_size <= 9 * max_size) break;
+    if (QFile::remove(file.absoluteFilePath())) total_size -= file.size();
+  }
+  debug_msg(DebugCache, "cleaned up disk cache" << total_size << max_size);
+}
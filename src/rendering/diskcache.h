@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+#include "src/config.h"
+#include "src/enumerates.h"
+
+class PngPixmap;
+
+/**
+ * @brief Persistent cache of compressed pages on disk.
+ *
+ * Rendered pages are stored in the user's cache directory (usually
+ * ~/.cache/beamerpresenter/pages). Entries are identified by the hash of the
+ * PDF file content, page, resolution, page part and renderer. Hence, entries
+ * remain valid when a presentation is opened again and become unused when
+ * the PDF file changes. The total size of cached pages and text indexes
+ * (see TextIndex) is limited by preferences()->disk_cache_size, least
+ * recently used entries are deleted first.
+ *
+ * All functions are thread save. One object of this class is used per
+ * PixCache and shared with its rendering threads. The hash of the PDF file
+ * is shared between all objects.
+ */
+class DiskCache
+{
+  /// Path of the PDF file.
+  const QString pdf_path;
+
+  /// Part of the page which is rendered.
+  const PagePart page_part;
+
+  /// Hash of a file together with the modification time of the file when
+  /// the hash was computed.
+  struct FileHash {
+    QDateTime time;
+    QByteArray hash;
+  };
+
+  /// Hashes of all files seen so far, indexed by path. Shared between all
+  /// DiskCache objects and TextIndex.
+  static QMap<QString, FileHash> file_hashes;
+
+  /// Mutex for file_hashes.
+  static QMutex hash_mutex;
+
+  /// Mutex for total_size, shared between all DiskCache objects.
+  static QMutex size_mutex;
+
+  /// Total size of the cache directory in bytes, shared between all
+  /// DiskCache objects. -1 if unknown.
+  static qint64 total_size;
+
+  /// Root directory of the page cache.
+  static QString cacheRoot();
+
+  /// Path to the cache file for given page and resolution. Return an
+  /// empty string if the PDF file cannot be read.
+  QString filePath(const int page, const qreal resolution);
+
+ public:
+  /// Constructor: only initializes path and page part.
+  DiskCache(const QString &path, const PagePart part) noexcept
+      : pdf_path(path), page_part(part)
+  {
+  }
+
+  /// Load page from disk. Return nullptr if the page is not cached.
+  /// The caller takes ownership of the returned object.
+  PngPixmap *load(const int page, const qreal resolution);
+
+  /// Write page to disk.
+  void store(const PngPixmap *pixmap);
+
+  /// SHA-1 hash of the content of the file at path (hex encoded). Return
+  /// an empty array if the file cannot be read. The hash is computed only
+  /// once for every path and modification time of the file.
+  static QByteArray fileHash(const QString &path);
+
+  /// Update total size after writing a file of given size to the cache
+  /// directory and delete least recently used files if necessary.
+  static void addSize(const qint64 bytes);
+
+  /// Check whether disk cache is enabled in preferences.
+  static bool enabled() noexcept;
+};
+
+#endif  // DISKCACHE_H
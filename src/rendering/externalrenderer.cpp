@@ -10,6 +10,7 @@
 #include "src/config.h"
 #include "src/enumerates.h"
 #include "src/log.h"
+#include "src/preferences.h"
 #include "src/rendering/pdfdocument.h"
 #include "src/rendering/pngpixmap.h"
 
@@ -54,7 +55,7 @@ const PngPixmap *ExternalRenderer::renderPng(const int page,
     qWarning() << "Invalid page or resolution" << page << resolution;
     return nullptr;
   }
-  if (page_part == FullPage) {
+  if (page_part == FullPage && preferences()->cache_codec == CacheCodec::PNG) {
     QProcess *process = new QProcess();
     process->start(renderingCommand, getArguments(page, resolution, "png"),
                    QProcess::ReadOnly);
@@ -71,7 +72,7 @@ const PngPixmap *ExternalRenderer::renderPng(const int page,
   }
   // If page_part != FullPage, it does not make any sense to directly load
   // the image in compressed (png) format, since we have to decompress and
-  // split it.
+  // split it. The same holds if the cache does not use PNG compression.
   const QPixmap pixmap = renderPixmap(page, resolution);
   return new PngPixmap(pixmap, page, resolution);
 }
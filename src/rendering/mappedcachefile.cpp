@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/rendering/mappedcachefile.h"
+
+#include <cstring>
+#include <utility>
+
+#include "src/log.h"
+
+MappedCacheFile::MappedCacheFile() : file(std::make_shared<QTemporaryFile>())
+{
+  if (!file->open()) qWarning() << "Could not open temporary cache file";
+}
+
+const QByteArray *MappedCacheFile::append(const QByteArray &data)
+{
+  if (!file->isOpen() || data.isEmpty()) return nullptr;
+  if (data.size() > segment_free) {
+    // Map a new segment at the end of the file. Large images get their own
+    // segment. Segments are aligned to 4 KiB.
+    const qint64 size =
+        data.size() > segment_size ? (data.size() + 0xfff) & ~0xfff
+                                   : segment_size;
+    if (!file->resize(file_size + size)) {
+      qWarning() << "Resizing cache file failed:" << file->errorString();
+      return nullptr;
+    }
+    uchar *new_segment = file->map(file_size, size);
+    if (new_segment == nullptr) {
+      qWarning() << "Mapping cache file failed:" << file->errorString();
+      file->resize(file_size);
+      return nullptr;
+    }
+    debug_msg(DebugCache, "mapped new cache file segment" << file_size << size);
+    // Old segments stay mapped until clear() is called.
+    segment = new_segment;
+    segment_free = size;
+    file_size += size;
+  }
+  char *target = reinterpret_cast<char *>(segment);
+  std::memcpy(target, data.constData(), data.size());
+  segment += data.size();
+  segment_free -= data.size();
+  used_size += data.size();
+  return new QByteArray(QByteArray::fromRawData(target, data.size()));
+}
+
+void MappedCacheFile::clear()
+{
+  if (!file->isOpen()) return;
+  // The old file is closed, which unmaps all segments, when the last cached
+  // image referencing it is deleted.
+  auto new_file = std::make_shared<QTemporaryFile>();
+  if (!new_file->open()) {
+    qWarning() << "Could not open temporary cache file";
+    return;
+  }
+  file = std::move(new_file);
+  segment = nullptr;
+  segment_free = 0;
+  file_size = 0;
+  used_size = 0;
+}
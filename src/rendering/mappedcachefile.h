@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef MAPPEDCACHEFILE_H
+#define MAPPEDCACHEFILE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QTemporaryFile>
+#include <memory>
+
+#include "src/config.h"
+
+/**
+ * @brief Append-only temporary file mapped to memory.
+ *
+ * Compressed pages can be moved to this file to keep the resident memory
+ * of the program small. The operating system can keep the pages of the file
+ * in memory as long as enough memory is available.
+ *
+ * Data is appended to memory mapped segments of the file. The returned
+ * QByteArrays reference the mapped memory directly and are only valid as
+ * long as the file returned by handle() at the time of appending exists.
+ * clear() replaces the file by a new one, the old file is unmapped and
+ * deleted when the last handle to it is released. Space of removed data is
+ * only freed by clear().
+ *
+ * Not thread save.
+ */
+class MappedCacheFile
+{
+  /// Size of a segment of the file which is mapped at once.
+  static constexpr qint64 segment_size = 1 << 26;
+
+  /// Temporary file, deleted when this object and all handles to it are
+  /// destroyed.
+  std::shared_ptr<QTemporaryFile> file;
+
+  /// Mapped segment currently used for appending data.
+  uchar *segment = nullptr;
+
+  /// Free bytes in segment.
+  qint64 segment_free = 0;
+
+  /// Total size of the file in bytes.
+  qint64 file_size = 0;
+
+  /// Bytes in file which are actually used.
+  qint64 used_size = 0;
+
+ public:
+  /// Constructor: open the temporary file.
+  MappedCacheFile();
+
+  /// Check whether the file can be used.
+  bool isValid() const noexcept { return file->isOpen(); }
+
+  /// Copy data to the file and return a QByteArray referencing the copy.
+  /// Return nullptr if this fails. The caller takes ownership of the
+  /// returned object, but not of the data it references.
+  const QByteArray *append(const QByteArray &data);
+
+  /// Bytes written to the file since the last call to clear().
+  qint64 size() const noexcept { return used_size; }
+
+  /// Handle keeping the current file and its mapped segments alive.
+  std::shared_ptr<const void> handle() const noexcept { return file; }
+
+  /// Start a new, empty file. Data in the old file stays valid as long as
+  /// handles to it exist.
+  void clear();
+};
+
+#endif  // MAPPEDCACHEFILE_H
@@ -10,6 +10,7 @@
 #include <QRectF>
 #include <QSizeF>
 #include <QUrl>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -22,6 +23,7 @@
 #include "src/log.h"
 #include "src/preferences.h"
 #include "src/rendering/mupdfdocument.h"
+#include "src/rendering/renderpool.h"
 
 #ifndef FZ_VERSION_MAJOR
 #define FZ_VERSION_MAJOR 0
@@ -104,7 +106,9 @@ MuPdfDocument::MuPdfDocument(const QString &filename)
 
 MuPdfDocument::~MuPdfDocument()
 {
+  RenderPool::instance().cancel(this);
   mutex->lock();
+  clearDisplayLists();
   for (auto page : std::as_const(pages)) fz_drop_page(ctx, (fz_page *)page);
   pdf_drop_document(ctx, doc);
   fz_drop_context(ctx);
@@ -138,10 +142,13 @@ bool MuPdfDocument::loadDocument()
   // Check if the file has changed since last (re)load
   if (doc && fileinfo.lastModified() == lastModified) return false;
   mutex->lock();
+  // Stop computing hashes of the old document.
+  ++load_epoch;
   if (doc) {
+    // Display lists do not depend on the document. Lists of pages which
+    // have not changed are kept.
     for (auto page : std::as_const(pages)) fz_drop_page(ctx, (fz_page *)page);
     pdf_drop_document(ctx, doc);
-    flexible_page_sizes = -1;
   } else {
     // This code is mainly copied from MuPDF example files, see mupdf.com
 
@@ -196,6 +203,7 @@ bool MuPdfDocument::loadDocument()
           tr("Error while loading file"),
           tr("MuPDF cannot open document: ") + fz_caught_message(ctx));
       doc = nullptr;
+      clearDisplayLists();
       fz_drop_context(ctx);
       ctx = nullptr;
       mutex->unlock();
@@ -219,6 +227,7 @@ bool MuPdfDocument::loadDocument()
           tr("No or invalid password provided for locked document"));
       pdf_drop_document(ctx, doc);
       doc = nullptr;
+      clearDisplayLists();
       fz_drop_context(ctx);
       ctx = nullptr;
       mutex->unlock();
@@ -232,25 +241,31 @@ bool MuPdfDocument::loadDocument()
   // Save number of pages.
   number_of_pages = pdf_count_pages(ctx, doc);
 
-  pages.resize(number_of_pages);
-  int i = 0;
+  // Pages are loaded when they are needed.
+  pages.fill(nullptr, number_of_pages);
+  loaded_pages.clear();
 
-#ifdef SUPPRESS_MUPDF_WARNINGS
-  fflush(stderr);
-  const int fd = dup(2);
-  const int nullfd = open("/dev/null", O_WRONLY);
-  dup2(nullfd, 2);
-  close(nullfd);
-#endif
-  do {
-    fz_try(ctx) pages[i] = pdf_load_page(ctx, doc, i);
-    fz_catch(ctx) pages[i] = nullptr;
-  } while (++i < number_of_pages);
-#ifdef SUPPRESS_MUPDF_WARNINGS
-  fflush(stderr);
-  dup2(fd, 2);
-  close(fd);
-#endif
+  // Page sizes are needed very often. Determine them once, this does not
+  // require loading the pages. Pages with invalid size get an empty size.
+  QVector<QSizeF> sizes(number_of_pages);
+  fz_rect bbox;
+  for (int page = 0; page < number_of_pages; ++page) {
+    fz_try(ctx) bbox = pageBounds(page);
+    fz_catch(ctx) continue;
+    // bbox.x0 and bbox.y0 should be 0, but keep them anyway:
+    sizes[page] = QSizeF(bbox.x1 - bbox.x0, bbox.y1 - bbox.y0);
+  }
+
+  // Changed pages are detected by comparing hashes of their content.
+  // Hashes of the previous version must be computed before the file
+  // changes, because MuPDF reads objects from the file only when they are
+  // needed. Hence, hashes are computed in the background after loading.
+  // Until the hashes of a reloaded document are known, only pages which
+  // were resized are marked as changed.
+  QVector<QByteArray> previous = storedPageHashes();
+  setPageTable(std::move(sizes));
+  dropDisplayLists(resizedPages());
+  hashPagesInBackground(std::move(previous));
 
   mutex->unlock();
 
@@ -258,29 +273,6 @@ bool MuPdfDocument::loadDocument()
   return number_of_pages > 0;
 }
 
-const QSizeF MuPdfDocument::pageSize(const int page) const
-{
-  // Check if the page number is valid.
-  if (!pages.value(page)) return QSizeF();
-
-  fz_rect bbox;
-  mutex->lock();
-  fz_try(ctx)
-  // Get bounding box.
-#if (FZ_VERSION_MAJOR > 1) || \
-    ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 23))
-      bbox = pdf_bound_page(ctx, pages[page], FZ_MEDIA_BOX);
-#else
-      bbox = pdf_bound_page(ctx, pages[page]);
-#endif
-  fz_always(ctx) mutex->unlock();
-  fz_catch(ctx) return QSizeF();
-
-  // Convert bounding box to QSizeF.
-  // bbox.x0 and bbox.y0 should be 0, but keep them anyway:
-  return QSizeF(bbox.x1 - bbox.x0, bbox.y1 - bbox.y0);
-}
-
 #if (FZ_VERSION_MAJOR > 1) || \
     ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 22))
 
@@ -455,23 +447,16 @@ void MuPdfDocument::prepareRendering(fz_context **context, fz_rect *bbox,
   // If it is not, return without changing the given pointers.
   // The caller should note that the pointers are unchaged and handle this
   // appropriately.
-  if (!pages.value(pagenumber) || resolution <= 0. || !ctx) return;
-
-  // This is almost completely copied from a mupdf example.
+  if (pagenumber < 0 || pagenumber >= number_of_pages || resolution <= 0. ||
+      !ctx)
+    return;
 
   mutex->lock();
   fz_try(ctx)
   {
     // sender gets a references to context.
     *context = ctx;
-    // Get a page (must be done in the main thread!).
-    // This causes warnings if the page contains multimedia content.
-#if (FZ_VERSION_MAJOR > 1) || \
-    ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 23))
-    *bbox = pdf_bound_page(ctx, pages[pagenumber], FZ_MEDIA_BOX);
-#else
-    *bbox = pdf_bound_page(ctx, pages[pagenumber]);
-#endif
+    *bbox = pageBounds(pagenumber);
     // Calculate the boundary box and rescale it to the given resolution.
     // bbox is now given in points. Convert to pixels using resolution, which
     // is given in pixels per point.
@@ -479,45 +464,350 @@ void MuPdfDocument::prepareRendering(fz_context **context, fz_rect *bbox,
     bbox->x1 *= resolution;
     bbox->y0 *= resolution;
     bbox->y1 *= resolution;
-
-    fz_device *dev = nullptr;
-    fz_var(*list);
-    fz_var(dev);
-    fz_try(ctx)
-    {
-      // Prepare a display list for a drawing device.
-      // The list (and not the page itself) will then be used to render the
-      // page.
-      *list = fz_new_display_list(ctx, *bbox);
-      // Use a fitz device to fill the list with the content of the page.
-      dev = fz_new_list_device(ctx, *list);
-      // One could use the "pdf_run_page_contents" function here instead to hide
-      // annotations. But there exist PDFs in which images are not rendered by
-      // that function.
-      pdf_run_page(ctx, pages[pagenumber], dev,
-                   fz_scale(resolution, resolution), nullptr);
-    }
-    fz_always(ctx) fz_drop_device(ctx, dev);
-    fz_catch(ctx)
-    {
-      fz_drop_display_list(ctx, *list);
-      *list = nullptr;
-    }
+    // Get the display list at unit scale.
+    *list = displayList(pagenumber);
   }
   fz_always(ctx) mutex->unlock();
   fz_catch(ctx) qWarning() << "Unhandled exception while preparing rendering"
                            << fz_caught_message(ctx);
 }
 
+fz_display_list *MuPdfDocument::displayList(const int page) const
+{
+  for (int i = 0; i < display_lists.length(); ++i) {
+    if (display_lists[i].first != page) continue;
+    display_lists.move(i, 0);
+    return fz_keep_display_list(ctx, display_lists.first().second);
+  }
+
+  // This is almost completely copied from a mupdf example.
+  // Get a page (must be done in the main thread!).
+  // This causes warnings if the page contains multimedia content.
+  pdf_page *const docpage = loadPage(page);
+  if (!docpage) return nullptr;
+  fz_display_list *list = newDisplayList(docpage, page);
+  if (!list) return nullptr;
+
+  // Keep the list in cache and limit the cache size.
+  const int max_lists = preferences()->max_display_lists;
+  if (max_lists != 0) {
+    display_lists.prepend({page, fz_keep_display_list(ctx, list)});
+    while (max_lists > 0 && display_lists.length() > max_lists)
+      fz_drop_display_list(ctx, display_lists.takeLast().second);
+  }
+  debug_verbose(DebugRendering,
+                "Created display list" << page << display_lists.length());
+  return list;
+}
+
+fz_display_list *MuPdfDocument::newDisplayList(pdf_page *docpage,
+                                               const int page) const
+{
+  fz_display_list *list = nullptr;
+  fz_device *dev = nullptr;
+  fz_var(list);
+  fz_var(dev);
+  fz_try(ctx)
+  {
+    // Prepare a display list for a drawing device.
+    // The list (and not the page itself) will then be used to render the
+    // page.
+    list = fz_new_display_list(ctx, pageBounds(page));
+    // Use a fitz device to fill the list with the content of the page.
+    dev = fz_new_list_device(ctx, list);
+    // One could use the "pdf_run_page_contents" function here instead to hide
+    // annotations. But there exist PDFs in which images are not rendered by
+    // that function.
+    pdf_run_page(ctx, docpage, dev, fz_identity, nullptr);
+    fz_close_device(ctx, dev);
+  }
+  fz_always(ctx) fz_drop_device(ctx, dev);
+  fz_catch(ctx)
+  {
+    qWarning() << "Failed to create display list:" << fz_caught_message(ctx);
+    fz_drop_display_list(ctx, list);
+    return nullptr;
+  }
+  return list;
+}
+
+fz_display_list *MuPdfDocument::uncachedDisplayList(const int page) const
+{
+  if (page < 0 || page >= pages.length()) return nullptr;
+  // Use a cached list without marking it as recently used.
+  for (const auto &item : std::as_const(display_lists))
+    if (item.first == page) return fz_keep_display_list(ctx, item.second);
+
+  // Use the loaded page or load it temporarily.
+  pdf_page *docpage = pages[page];
+  const bool temporary = docpage == nullptr;
+  if (temporary) {
+    fz_try(ctx) docpage = pdf_load_page(ctx, doc, page);
+    fz_catch(ctx) docpage = nullptr;
+    if (!docpage) return nullptr;
+  }
+  fz_display_list *list = newDisplayList(docpage, page);
+  if (temporary) fz_drop_page(ctx, (fz_page *)docpage);
+  return list;
+}
+
+void MuPdfDocument::clearDisplayLists() const
+{
+  for (const auto &item : std::as_const(display_lists))
+    fz_drop_display_list(ctx, item.second);
+  display_lists.clear();
+}
+
+void MuPdfDocument::dropDisplayLists(const QList<int> &page_list) const
+{
+  for (auto it = display_lists.begin(); it != display_lists.end();) {
+    if (page_list.contains(it->first)) {
+      fz_drop_display_list(ctx, it->second);
+      it = display_lists.erase(it);
+    } else
+      ++it;
+  }
+}
+
+void MuPdfDocument::hashObject(pdf_obj *obj, fz_md5 *state,
+                               QHash<int, ObjectDigest> *digests) const
+{
+  if (pdf_is_indirect(ctx, obj)) {
+    // References to pages, e.g. in link destinations, would include the
+    // content of other pages.
+    if (pdf_name_eq(ctx,
+                    pdf_dict_get(ctx, pdf_resolve_indirect(ctx, obj),
+                                 PDF_NAME(Type)),
+                    PDF_NAME(Page))) {
+      fz_md5_update(state, reinterpret_cast<const unsigned char *>("P"), 1);
+      return;
+    }
+    const int num = pdf_to_num(ctx, obj);
+    if (!digests->contains(num)) {
+      // Insert a placeholder, which is used for cyclic references.
+      digests->insert(num, ObjectDigest{});
+      fz_md5 object_state;
+      fz_md5_init(&object_state);
+      hashObject(pdf_resolve_indirect(ctx, obj), &object_state, digests);
+      if (pdf_is_stream(ctx, obj)) {
+        // Compressed stream data is sufficient to identify the content.
+        fz_buffer *buffer = pdf_load_raw_stream_number(ctx, doc, num);
+        unsigned char *data;
+        const size_t length = fz_buffer_storage(ctx, buffer, &data);
+        fz_md5_update(&object_state, data, length);
+        fz_drop_buffer(ctx, buffer);
+      }
+      ObjectDigest digest;
+      fz_md5_final(&object_state, digest.data());
+      digests->insert(num, digest);
+    }
+    const ObjectDigest digest = digests->value(num);
+    fz_md5_update(state, digest.data(), digest.size());
+    return;
+  }
+
+  if (pdf_is_dict(ctx, obj)) {
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>("<<"), 2);
+    const int length = pdf_dict_len(ctx, obj);
+    for (int i = 0; i < length; ++i) {
+      pdf_obj *key = pdf_dict_get_key(ctx, obj, i);
+      // Parents would include the whole page tree.
+      if (pdf_name_eq(ctx, key, PDF_NAME(Parent)) ||
+          pdf_name_eq(ctx, key, PDF_NAME(P)))
+        continue;
+      hashObject(key, state, digests);
+      hashObject(pdf_dict_get_val(ctx, obj, i), state, digests);
+    }
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>(">>"), 2);
+  } else if (pdf_is_array(ctx, obj)) {
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>("["), 1);
+    const int length = pdf_array_len(ctx, obj);
+    for (int i = 0; i < length; ++i)
+      hashObject(pdf_array_get(ctx, obj, i), state, digests);
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>("]"), 1);
+  } else if (pdf_is_name(ctx, obj)) {
+    const char *name = pdf_to_name(ctx, obj);
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>("/"), 1);
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>(name),
+                  strlen(name));
+  } else if (pdf_is_string(ctx, obj)) {
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>("("), 1);
+    fz_md5_update(state,
+                  reinterpret_cast<const unsigned char *>(
+                      pdf_to_str_buf(ctx, obj)),
+                  pdf_to_str_len(ctx, obj));
+  } else if (pdf_is_int(ctx, obj)) {
+    const int value = pdf_to_int(ctx, obj);
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>(&value),
+                  sizeof(value));
+  } else if (pdf_is_real(ctx, obj)) {
+    const float value = pdf_to_real(ctx, obj);
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>(&value),
+                  sizeof(value));
+  } else if (pdf_is_bool(ctx, obj)) {
+    fz_md5_update(state,
+                  reinterpret_cast<const unsigned char *>(
+                      pdf_to_bool(ctx, obj) ? "T" : "F"),
+                  1);
+  } else
+    fz_md5_update(state, reinterpret_cast<const unsigned char *>("N"), 1);
+}
+
+QByteArray MuPdfDocument::pageHash(const int page,
+                                   QHash<int, ObjectDigest> *digests) const
+{
+  fz_md5 state;
+  fz_md5_init(&state);
+  fz_try(ctx)
+  {
+    // The page object itself is a reference to a page, which hashObject()
+    // would skip. Hash its dictionary instead.
+    pdf_obj *pageobj =
+        pdf_resolve_indirect(ctx, pdf_lookup_page_obj(ctx, doc, page));
+    hashObject(pageobj, &state, digests);
+    // These entries may be inherited from the page tree.
+    for (pdf_obj *key : {PDF_NAME(Resources), PDF_NAME(Rotate),
+                         PDF_NAME(MediaBox), PDF_NAME(CropBox)})
+      hashObject(pdf_dict_get_inheritable(ctx, pageobj, key), &state,
+                 digests);
+  }
+  fz_catch(ctx) return QByteArray();
+  ObjectDigest digest;
+  fz_md5_final(&state, digest.data());
+  return QByteArray(reinterpret_cast<const char *>(digest.data()),
+                    digest.size());
+}
+
+void MuPdfDocument::hashPagesInBackground(QVector<QByteArray> previous)
+{
+  const unsigned int epoch = load_epoch;
+  pending_hashes = QVector<QByteArray>(number_of_pages);
+  previous_hashes = std::move(previous);
+  object_digests.clear();
+  unhashed_pages = number_of_pages;
+  // Hashes are needed soon if the document was reloaded.
+  const RenderPool::Priority priority = previous_hashes.isEmpty()
+                                            ? RenderPool::Hashing
+                                            : RenderPool::VisiblePage;
+  for (int page = 0; page < number_of_pages; ++page)
+    RenderPool::instance().submit(this, priority, [this, epoch, page]() {
+      hashPage(epoch, page);
+    });
+}
+
+void MuPdfDocument::hashPage(const unsigned int epoch, const int page)
+{
+  mutex->lock();
+  if (epoch != load_epoch) {
+    mutex->unlock();
+    return;
+  }
+  pending_hashes[page] = pageHash(page, &object_digests);
+  QList<std::function<void()>> handlers;
+  if (--unhashed_pages == 0) {
+    // Hashes are useless if the file has changed while reading it.
+    if (QFileInfo(path).lastModified() != lastModified)
+      pending_hashes.fill(QByteArray());
+    setPageHashes(std::move(pending_hashes), previous_hashes);
+    // Drop display lists of pages which have changed.
+    if (!previous_hashes.isEmpty()) dropDisplayLists(changedPages());
+    pending_hashes.clear();
+    previous_hashes.clear();
+    object_digests.clear();
+    handlers.swap(changes_handlers);
+    debug_msg(DebugCache, "computed page hashes" << path);
+  }
+  mutex->unlock();
+  for (const auto &handler : std::as_const(handlers)) handler();
+}
+
+void MuPdfDocument::whenChangesKnown(std::function<void()> handler)
+{
+  mutex->lock();
+  if (unhashed_pages > 0) {
+    changes_handlers.append(std::move(handler));
+    mutex->unlock();
+    return;
+  }
+  mutex->unlock();
+  handler();
+}
+
+pdf_page *MuPdfDocument::loadPage(const int page) const
+{
+  if (page < 0 || page >= pages.length()) return nullptr;
+  const int max_pages = preferences()->max_loaded_pages;
+  if (pages[page]) {
+    if (max_pages > 0 &&
+        (loaded_pages.isEmpty() || loaded_pages.first() != page)) {
+      loaded_pages.removeOne(page);
+      loaded_pages.prepend(page);
+    }
+    return pages[page];
+  }
+
+#ifdef SUPPRESS_MUPDF_WARNINGS
+  fflush(stderr);
+  const int fd = dup(2);
+  const int nullfd = open("/dev/null", O_WRONLY);
+  dup2(nullfd, 2);
+  close(nullfd);
+#endif
+  fz_try(ctx) pages[page] = pdf_load_page(ctx, doc, page);
+  fz_catch(ctx) pages[page] = nullptr;
+#ifdef SUPPRESS_MUPDF_WARNINGS
+  fflush(stderr);
+  dup2(fd, 2);
+  close(fd);
+#endif
+  if (!pages[page]) {
+    qWarning() << "Failed to load page" << page;
+    return nullptr;
+  }
+  debug_verbose(DebugRendering, "Loaded page" << page);
+
+  // Limit the number of loaded pages.
+  if (max_pages > 0) {
+    loaded_pages.prepend(page);
+    while (loaded_pages.length() > max_pages) {
+      const int old_page = loaded_pages.takeLast();
+      fz_drop_page(ctx, (fz_page *)pages[old_page]);
+      pages[old_page] = nullptr;
+    }
+  }
+  return pages[page];
+}
+
+fz_rect MuPdfDocument::pageBounds(const int page) const
+{
+  // This is equivalent to pdf_bound_page, but does not require loading the
+  // page.
+  fz_rect mediabox;
+  fz_matrix ctm;
+  pdf_obj *pageobj = pdf_lookup_page_obj(ctx, doc, page);
+#if (FZ_VERSION_MAJOR > 1) || \
+    ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 23))
+  pdf_page_obj_transform_box(ctx, pageobj, &mediabox, &ctm, FZ_MEDIA_BOX);
+#else
+  pdf_page_obj_transform(ctx, pageobj, &mediabox, &ctm);
+#endif
+  return fz_transform_rect(mediabox, ctm);
+}
+
 const SlideTransition MuPdfDocument::transition(const int page) const
 {
   SlideTransition trans;
-  if (!pages.value(page) || !ctx) return trans;
+  if (page < 0 || page >= number_of_pages || !ctx) return trans;
 
   mutex->lock();
+  pdf_page *const docpage = loadPage(page);
+  if (!docpage) {
+    mutex->unlock();
+    return trans;
+  }
   fz_transition doc_trans = {0, 0., 0, 0, 0, 0, 0};
   float duration = 0.;
-  fz_try(ctx) pdf_page_presentation(ctx, pages[page], &doc_trans, &duration);
+  fz_try(ctx) pdf_page_presentation(ctx, docpage, &doc_trans, &duration);
   fz_catch(ctx)
   {
     mutex->unlock();
@@ -536,7 +826,7 @@ const SlideTransition MuPdfDocument::transition(const int page) const
   if (trans.type == SlideTransition::Fly) {
     fz_try(ctx)
     {
-      pdf_obj *transdict = pdf_dict_get(ctx, pages[page]->obj, PDF_NAME(Trans));
+      pdf_obj *transdict = pdf_dict_get(ctx, docpage->obj, PDF_NAME(Trans));
       if (pdf_dict_get_bool(ctx, transdict, PDF_NAME(B)))
         trans.type = SlideTransition::FlyRectangle;
       pdf_obj *ss_obj = pdf_dict_gets(ctx, transdict, "SS");
@@ -553,16 +843,21 @@ const SlideTransition MuPdfDocument::transition(const int page) const
 const PdfLink *MuPdfDocument::linkAt(const int page,
                                      const QPointF &position) const
 {
-  if (!pages.value(page) || !ctx || !doc) return nullptr;
+  if (page < 0 || page >= number_of_pages || !ctx || !doc) return nullptr;
 
   mutex->lock();
+  pdf_page *const docpage = loadPage(page);
+  if (!docpage) {
+    mutex->unlock();
+    return nullptr;
+  }
   PdfLink *result = nullptr;
   fz_link *clink = nullptr;
   fz_var(clink);
   fz_var(result);
   fz_try(ctx)
   {
-    clink = pdf_load_links(ctx, pages[page]);
+    clink = pdf_load_links(ctx, docpage);
     for (fz_link *link = clink; link != nullptr; link = link->next) {
       if (link->uri && link->rect.x0 <= position.x() &&
           link->rect.x1 >= position.x() && link->rect.y0 <= position.y() &&
@@ -603,16 +898,57 @@ const PdfLink *MuPdfDocument::linkAt(const int page,
   return result;
 }
 
+QList<int> MuPdfDocument::linkTargets(const int page) const
+{
+  if (page < 0 || page >= number_of_pages || !ctx || !doc) return {};
+
+  mutex->lock();
+  pdf_page *const docpage = loadPage(page);
+  if (!docpage) {
+    mutex->unlock();
+    return {};
+  }
+  QList<int> targets;
+  fz_link *clink = nullptr;
+  fz_var(clink);
+  fz_var(targets);
+  fz_try(ctx)
+  {
+    clink = pdf_load_links(ctx, docpage);
+    for (fz_link *link = clink; link != nullptr; link = link->next) {
+      if (link->uri && link->uri[0] == '#') {
+        float x, y;
+        const int location = pdf_resolve_link(ctx, doc, link->uri, &x, &y);
+        if (location >= 0 && !targets.contains(location))
+          targets.append(location);
+      }
+    }
+  }
+  fz_always(ctx)
+  {
+    fz_drop_link(ctx, clink);
+    mutex->unlock();
+  }
+  fz_catch(ctx) qWarning() << "Error while loading link"
+                           << fz_caught_message(ctx);
+  return targets;
+}
+
 QList<std::shared_ptr<MediaAnnotation>> MuPdfDocument::annotations(
     const int page)
 {
   QList<std::shared_ptr<MediaAnnotation>> list;
-  if (!pages.value(page) || !ctx) return {};
+  if (page < 0 || page >= number_of_pages || !ctx) return {};
   mutex->lock();
+  pdf_page *const docpage = loadPage(page);
+  if (!docpage) {
+    mutex->unlock();
+    return {};
+  }
   fz_var(list);
   fz_try(ctx)
   {
-    for (pdf_annot *annot = pdf_first_annot(ctx, pages[page]); annot != nullptr;
+    for (pdf_annot *annot = pdf_first_annot(ctx, docpage); annot != nullptr;
          annot = pdf_next_annot(ctx, annot)) {
       debug_verbose(DebugMedia,
                     "PDF annotation:" << pdf_annot_type(ctx, annot) << page);
@@ -775,36 +1111,6 @@ QList<std::shared_ptr<MediaAnnotation>> MuPdfDocument::annotations(
   return list;
 }
 
-bool MuPdfDocument::flexiblePageSizes() noexcept
-{
-  if (flexible_page_sizes >= 0 || !ctx || !pages.value(0))
-    return flexible_page_sizes;
-
-  flexible_page_sizes = 0;
-  mutex->lock();
-#if (FZ_VERSION_MAJOR > 1) || \
-    ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 23))
-  const fz_rect ref_bbox = pdf_bound_page(ctx, pages[0], FZ_MEDIA_BOX);
-#else
-  const fz_rect ref_bbox = pdf_bound_page(ctx, pages[0]);
-#endif
-  fz_rect bbox;
-  for (auto page : std::as_const(pages)) {
-#if (FZ_VERSION_MAJOR > 1) || \
-    ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 23))
-    bbox = pdf_bound_page(ctx, page, FZ_MEDIA_BOX);
-#else
-    bbox = pdf_bound_page(ctx, page);
-#endif
-    if (bbox.x1 != ref_bbox.x1 || bbox.y1 != ref_bbox.y1) {
-      flexible_page_sizes = 1;
-      break;
-    }
-  }
-  mutex->unlock();
-  return flexible_page_sizes;
-}
-
 void MuPdfDocument::loadLabels()
 {
   loadOutline();
@@ -881,14 +1187,14 @@ std::pair<int, QRectF> MuPdfDocument::search(const QString &needle,
   mutex->lock();
   if (forward)
     for (int page = start_page; page < number_of_pages; ++page) {
+      fz_page *const docpage = (fz_page *)loadPage(page);
+      if (!docpage) continue;
       fz_try(ctx)
 #if (FZ_VERSION_MAJOR > 1) || \
     ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 20))
-          hit = fz_search_page(ctx, (fz_page *const)(pages[page]), raw_needle,
-                               &hit_mark, &rect, 1);
+          hit = fz_search_page(ctx, docpage, raw_needle, &hit_mark, &rect, 1);
 #else
-          hit = fz_search_page(ctx, (fz_page *const)(pages[page]), raw_needle,
-                               &rect, 1);
+          hit = fz_search_page(ctx, docpage, raw_needle, &rect, 1);
 #endif
       fz_catch(ctx) hit = 0;
       if (hit) {
@@ -900,14 +1206,14 @@ std::pair<int, QRectF> MuPdfDocument::search(const QString &needle,
     }
   else
     for (int page = start_page; page >= 0; --page) {
+      fz_page *const docpage = (fz_page *)loadPage(page);
+      if (!docpage) continue;
       fz_try(ctx)
 #if (FZ_VERSION_MAJOR > 1) || \
     ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 20))
-          hit = fz_search_page(ctx, (fz_page *const)(pages[page]), raw_needle,
-                               &hit_mark, &rect, 1);
+          hit = fz_search_page(ctx, docpage, raw_needle, &hit_mark, &rect, 1);
 #else
-          hit = fz_search_page(ctx, (fz_page *const)(pages[page]), raw_needle,
-                               &rect, 1);
+          hit = fz_search_page(ctx, docpage, raw_needle, &rect, 1);
 #endif
       fz_catch(ctx) hit = 0;
       if (hit) {
@@ -960,14 +1266,19 @@ int MuPdfDocument::searchPage(const int page, const char *raw_needle,
 #endif
   fz_quad rects[max_search_results];
   mutex->lock();
+  pdf_page *const docpage = loadPage(page);
+  if (!docpage) {
+    mutex->unlock();
+    return 0;
+  }
   fz_try(ctx)
 #if (FZ_VERSION_MAJOR > 1) || \
     ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 20))
-      count = fz_search_page(ctx, (fz_page *const)(pages[page]), raw_needle,
-                             hit_mark, rects, max_search_results);
-#else
-      count = fz_search_page(ctx, (fz_page *const)(pages[page]), raw_needle,
+      count = fz_search_page(ctx, (fz_page *const)docpage, raw_needle, hit_mark,
                              rects, max_search_results);
+#else
+      count = fz_search_page(ctx, (fz_page *const)docpage, raw_needle, rects,
+                             max_search_results);
 #endif
   fz_always(ctx) mutex->unlock();
   fz_catch(ctx) count = 0;
@@ -979,14 +1290,67 @@ int MuPdfDocument::searchPage(const int page, const char *raw_needle,
   return count;
 }
 
+bool MuPdfDocument::pageText(const int page, PdfPageText &target) const
+{
+  if (page < 0 || page >= number_of_pages || !ctx) return false;
+  // The display list is created at unit scale, such that the extracted
+  // positions are given in points. It is not added to the cache used for
+  // rendering.
+  mutex->lock();
+  fz_display_list *list = uncachedDisplayList(page);
+  mutex->unlock();
+  if (list == nullptr) return false;
+  // Work with a clone of the context, the document is not needed anymore.
+  fz_context *context = fz_clone_context(ctx);
+  fz_stext_page *stext = nullptr;
+  bool success = true;
+  fz_var(stext);
+  fz_try(context)
+  {
+    stext = fz_new_stext_page_from_display_list(context, list, nullptr);
+    for (fz_stext_block *block = stext->first_block; block;
+         block = block->next) {
+      if (block->type != FZ_STEXT_BLOCK_TEXT) continue;
+      for (fz_stext_line *line = block->u.t.first_line; line;
+           line = line->next) {
+        for (fz_stext_char *ch = line->first_char; ch; ch = ch->next) {
+          const fz_rect rect = fz_rect_from_quad(ch->quad);
+          const QRectF box(rect.x0, rect.y0, rect.x1 - rect.x0,
+                           rect.y1 - rect.y0);
+          if (QChar::requiresSurrogates(ch->c)) {
+            target.append(QChar::highSurrogate(ch->c), box);
+            target.append(QChar::lowSurrogate(ch->c), box);
+          } else
+            target.append(QChar(ch->c), box);
+        }
+        target.append(' ', QRectF());
+      }
+    }
+  }
+  fz_always(context)
+  {
+    fz_drop_stext_page(context, stext);
+    fz_drop_display_list(context, list);
+  }
+  fz_catch(context)
+  {
+    qWarning() << "Error while extracting text:" << fz_caught_message(context);
+    success = false;
+  }
+  fz_drop_context(context);
+  return success;
+}
+
 qreal MuPdfDocument::duration(const int page) const noexcept
 {
-  if (!pages.value(page) || !ctx) return -1.;
+  if (page < 0 || page >= number_of_pages || !ctx) return -1.;
   mutex->lock();
   qreal duration = 0.;
   fz_try(ctx)
   {
-    pdf_obj *obj = pdf_dict_get(ctx, pages[page]->obj, PDF_NAME(Dur));
+    // The page object is sufficient, the page does not need to be loaded.
+    pdf_obj *obj =
+        pdf_dict_get(ctx, pdf_lookup_page_obj(ctx, doc, page), PDF_NAME(Dur));
     duration = obj ? pdf_to_real(ctx, obj) : -1.;
   }
   fz_always(ctx) mutex->unlock();
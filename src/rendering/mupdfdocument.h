@@ -4,12 +4,16 @@
 #ifndef MUPDFDOCUMENT_H
 #define MUPDFDOCUMENT_H
 
+#include <QByteArray>
 #include <QCoreApplication>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QMutex>
 #include <QString>
 #include <QVector>
+#include <array>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -57,8 +61,13 @@ class MuPdfDocument : public PdfDocument
 #endif  // FZ_VERSION < 1.22
 
  private:
-  /// List of all pages.
-  QVector<pdf_page *> pages;
+  /// List of all pages. Pages are loaded when they are first needed,
+  /// pages which are not loaded are nullptr.
+  mutable QVector<pdf_page *> pages;
+
+  /// Loaded pages, most recently used pages first. This is only used if the
+  /// number of loaded pages is limited by preferences()->max_loaded_pages.
+  mutable QList<int> loaded_pages;
 
   /// context should be cloned for each separate thread.
   fz_context *ctx{nullptr};
@@ -75,6 +84,86 @@ class MuPdfDocument : public PdfDocument
   /// Total number of pages in document.
   int number_of_pages;
 
+  /// Display lists of pages at unit scale (1 pixel per point), most recently
+  /// used pages first. The number of display lists is limited by
+  /// preferences()->max_display_lists. Access is protected by mutex.
+  mutable QList<std::pair<int, fz_display_list *>> display_lists;
+
+  /// Return a new reference to the display list of given page at unit scale.
+  /// The list is created if it is not cached yet. mutex must be locked.
+  /// The caller must drop the returned list.
+  fz_display_list *displayList(const int page) const;
+
+  /// Create a new display list of docpage at unit scale. Return nullptr if
+  /// this fails. mutex must be locked. The caller must drop the list.
+  fz_display_list *newDisplayList(pdf_page *docpage, const int page) const;
+
+  /// Return a new reference to a display list of page without changing the
+  /// cached display lists and loaded pages. mutex must be locked. The caller
+  /// must drop the returned list.
+  fz_display_list *uncachedDisplayList(const int page) const;
+
+  /// Drop all cached display lists. mutex must be locked.
+  void clearDisplayLists() const;
+
+  /// Drop cached display lists of the given pages. mutex must be locked.
+  void dropDisplayLists(const QList<int> &page_list) const;
+
+  /// MD5 digest of a PDF object.
+  using ObjectDigest = std::array<unsigned char, 16>;
+
+  /// Incremented whenever the document is (re)loaded, such that outdated
+  /// background jobs can be detected. Access is protected by mutex.
+  unsigned int load_epoch = 0;
+
+  /// Page hashes of the current version computed so far, previous hashes
+  /// to which they are compared and digests of shared objects. Access is
+  /// protected by mutex.
+  QVector<QByteArray> pending_hashes, previous_hashes;
+  QHash<int, ObjectDigest> object_digests;
+
+  /// Number of pages which still need to be hashed. Access is protected by
+  /// mutex.
+  int unhashed_pages = 0;
+
+  /// Handlers waiting for changedPages(), see whenChangesKnown(). Access is
+  /// protected by mutex.
+  QList<std::function<void()>> changes_handlers;
+
+  /// Add obj and all objects referenced by it to state, except for
+  /// references to pages and to parents in the page tree and annotation
+  /// tree. Digests of indirect objects are computed only once and stored in
+  /// digests, which also avoids infinite recursion. mutex must be locked.
+  /// This may throw MuPDF exceptions.
+  void hashObject(pdf_obj *obj, fz_md5 *state,
+                  QHash<int, ObjectDigest> *digests) const;
+
+  /// Hash of the page dictionary, including contents, annotations and page
+  /// boxes, and of the inherited resources of page. Empty if the page cannot
+  /// be read. Digests of shared objects are kept in digests.
+  /// mutex must be locked.
+  QByteArray pageHash(const int page, QHash<int, ObjectDigest> *digests) const;
+
+  /// Compute the hashes of all pages in the RenderPool, one job per page,
+  /// and store them in the page table, such that they can be compared when
+  /// the document is reloaded. Changed pages are determined by comparing
+  /// with previous (empty when loading for the first time). mutex must be
+  /// locked.
+  void hashPagesInBackground(QVector<QByteArray> previous);
+
+  /// Job of hashPagesInBackground(): hash page unless the document has been
+  /// reloaded since epoch. The last job updates the page table.
+  void hashPage(const unsigned int epoch, const int page);
+
+  /// Return the given page, load it if necessary. Return nullptr if the page
+  /// cannot be loaded. mutex must be locked. The page remains owned by this
+  /// and may be dropped after mutex has been unlocked.
+  pdf_page *loadPage(const int page) const;
+
+  /// Bounding box of page in points, obtained without loading the page.
+  /// mutex must be locked. This may throw MuPDF exceptions.
+  fz_rect pageBounds(const int page) const;
+
   /// Map of PDF object numbers to embedded media data streams
   QMap<int, std::shared_ptr<QByteArray>> embedded_media;
 
@@ -95,7 +184,7 @@ class MuPdfDocument : public PdfDocument
   /// Constructor: Create mutexes and load document using loadDocument().
   MuPdfDocument(const QString &filename);
 
-  /// Destructor: delete mutexes, drop doc and ctx.
+  /// Destructor: cancel background jobs, delete mutexes, drop doc and ctx.
   ~MuPdfDocument() override;
 
   PdfEngine type() const noexcept override { return PdfEngine::MuPdf; }
@@ -104,9 +193,6 @@ class MuPdfDocument : public PdfDocument
   /// it was loaded. Return true if the document was reloaded.
   bool loadDocument() override final;
 
-  /// Size of page in points (inch/72).
-  const QSizeF pageSize(const int page) const override;
-
   /// Check whether a file has been loaded successfully.
   bool isValid() const noexcept override
   {
@@ -139,25 +225,40 @@ class MuPdfDocument : public PdfDocument
                                           int start_page = 0,
                                           bool forward = true) const override;
 
+  /// Text extraction is supported.
+  bool hasPageText() const noexcept override { return true; }
+
+  /// Extract text of page from its display list. The document mutex is only
+  /// locked while obtaining the display list. Pages and display lists used
+  /// for rendering are not evicted from cache by this.
+  bool pageText(const int page, PdfPageText &target) const override;
+
+  /// Call handler once all pages have been hashed after (re)loading the
+  /// document. handler may be called from a worker thread.
+  void whenChangesKnown(std::function<void()> handler) override;
+
   /// Link at given position (in point = inch/72)
   virtual const PdfLink *linkAt(const int page,
                                 const QPointF &position) const override;
 
+  /// Target pages of all internal navigation links on given page.
+  QList<int> linkTargets(const int page) const override;
+
   /// List all video annotations on given page.
   virtual QList<std::shared_ptr<MediaAnnotation>> annotations(
       const int page) override;
 
   /// Prepare rendering for other threads by initializing the given pointers.
   /// This gives the threads only access to objects which are thread save.
+  /// bbox is scaled to the given resolution, but the display list is cached
+  /// at unit scale: it must be run with transformation
+  /// fz_scale(resolution, resolution).
   void prepareRendering(fz_context **context, fz_rect *bbox,
                         fz_display_list **list, const int pagenumber,
                         const qreal resolution) const;
 
   /// Slide transition when reaching the given page.
   const SlideTransition transition(const int page) const override;
-
-  /// Return true if not all pages in the PDF have the same size.
-  virtual bool flexiblePageSizes() noexcept override;
 };
 
 /// Lock mutex <lock> in vector <user> of mutexes.
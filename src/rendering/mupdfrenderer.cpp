@@ -3,11 +3,13 @@
 
 #include "src/rendering/mupdfrenderer.h"
 
-#include <QByteArray>
+#include <QImage>
 #include <QPixmap>
+#include <algorithm>
 
 #include "src/config.h"
 #include "src/log.h"
+#include "src/preferences.h"
 #include "src/rendering/mupdfdocument.h"
 #include "src/rendering/pngpixmap.h"
 
@@ -18,18 +20,37 @@
 #define FZ_VERSION_MINOR 0
 #endif
 
-fz_pixmap *MuPdfRenderer::renderFzPixmap(const int page, const qreal resolution,
-                                         fz_context *&ctx) const
+/// Pixel format of images rendered by MuPDF. The draw device writes pixels
+/// with alpha channel, which is always opaque since the pixmap is filled with
+/// white background. With BGR byte order this is the native format of
+/// QImage::Format_RGB32 on little endian systems.
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+#define MUPDF_COLORSPACE fz_device_bgr
+static constexpr QImage::Format mupdf_image_format = QImage::Format_RGB32;
+#else
+#define MUPDF_COLORSPACE fz_device_rgb
+static constexpr QImage::Format mupdf_image_format = QImage::Format_RGBX8888;
+#endif
+
+const QImage MuPdfRenderer::renderImage(const int page,
+                                        const qreal resolution,
+                                        const QRect &tile) const
 {
-  if (resolution < 1e-9 || resolution > 1e9 || page < 0) return nullptr;
+  // Tiles may be rendered with resolutions exceeding max_image_size.
+  if (resolution < 1e-9 || resolution > 1e9 || page < 0 || !doc ||
+      (tile.isValid()
+           ? qreal(tile.width()) * tile.height() > preferences()->max_image_size
+           : !doc->checkResolution(page, resolution)))
+    return QImage();
 
   // Let the main thread prepare everything.
+  fz_context *ctx = nullptr;
   fz_rect bbox;
   fz_display_list *list = nullptr;
   doc->prepareRendering(&ctx, &bbox, &list, page, resolution);
 
   // If page is not valid (too large), the nullptr will be unchanged.
-  if (ctx == nullptr || list == nullptr) return nullptr;
+  if (ctx == nullptr || list == nullptr) return QImage();
 
   // Adapt bbox to page part.
   switch (page_part) {
@@ -46,140 +67,107 @@ fz_pixmap *MuPdfRenderer::renderFzPixmap(const int page, const qreal resolution,
   // Create a local clone of the main thread's context.
   ctx = fz_clone_context(ctx);
 
-  // Create pixmap and render page to it.
+#if (FZ_VERSION_MAJOR > 1) || \
+    ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 13))
+  fz_irect irect = fz_round_rect(bbox);
+#else
+  fz_irect irect = fz_irect_from_rect(bbox);
+#endif
+  if (tile.isValid()) {
+    // Restrict the rendered area to the tile.
+    const fz_irect full = irect;
+    irect.x0 = full.x0 + tile.left();
+    irect.y0 = full.y0 + tile.top();
+    irect.x1 = std::min(full.x1, irect.x0 + tile.width());
+    irect.y1 = std::min(full.y1, irect.y0 + tile.height());
+    bbox.x0 = irect.x0;
+    bbox.y0 = irect.y0;
+    bbox.x1 = irect.x1;
+    bbox.y1 = irect.y1;
+  }
+  if (irect.x1 <= irect.x0 || irect.y1 <= irect.y0) {
+    fz_drop_display_list(ctx, list);
+    fz_drop_context(ctx);
+    return QImage();
+  }
+  // The image owns the memory to which MuPDF renders.
+  QImage image(irect.x1 - irect.x0, irect.y1 - irect.y0, mupdf_image_format);
+  if (image.isNull()) {
+    qWarning() << "Failed to allocate image for rendering";
+    fz_drop_display_list(ctx, list);
+    fz_drop_context(ctx);
+    return image;
+  }
+
+  // Create pixmap using the memory of image and render page to it.
   fz_device *dev = nullptr;
   fz_pixmap *pixmap = nullptr;
   fz_var(pixmap);
   fz_var(dev);
   fz_try(ctx)
   {
-    // Create the pixmap and fill it with white background.
 #if (FZ_VERSION_MAJOR > 1) || \
     ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 13))
-    pixmap = fz_new_pixmap_with_bbox(ctx, fz_device_rgb(ctx),
-                                     fz_round_rect(bbox), nullptr, 0);
+    pixmap = fz_new_pixmap_with_data(ctx, MUPDF_COLORSPACE(ctx), image.width(),
+                                     image.height(), nullptr, 1,
+                                     image.bytesPerLine(), image.bits());
 #else
-    pixmap = fz_new_pixmap_with_bbox(ctx, fz_device_rgb(ctx),
-                                     fz_irect_from_rect(bbox), nullptr, 0);
+    pixmap = fz_new_pixmap_with_data(ctx, MUPDF_COLORSPACE(ctx), image.width(),
+                                     image.height(), 1, image.bytesPerLine(),
+                                     image.bits());
 #endif
+    pixmap->x = irect.x0;
+    pixmap->y = irect.y0;
+    // Fill the pixmap with white background.
     fz_clear_pixmap_with_value(ctx, pixmap, 0xff);
     // Create a device for rendering the given display list to pixmap.
     dev = fz_new_draw_device(ctx, fz_identity, pixmap);
     // Do the main work: Render the display list to pixmap.
-    fz_run_display_list(ctx, list, dev, fz_identity, bbox, nullptr);
+    // The list is given at unit scale, scale it to the given resolution.
+    fz_run_display_list(ctx, list, dev, fz_scale(resolution, resolution), bbox,
+                        &cookie);
     fz_close_device(ctx, dev);
   }
   fz_always(ctx)
   {
     fz_drop_device(ctx, dev);
+    // This does not free the samples, which are owned by image.
+    fz_drop_pixmap(ctx, pixmap);
     fz_drop_display_list(ctx, list);
   }
   fz_catch(ctx)
   {
     qWarning() << "Fitz failed to create or render pixmap:"
                << fz_caught_message(ctx);
-    fz_drop_pixmap(ctx, pixmap);
-    fz_drop_context(ctx);
-    return nullptr;
+    image = QImage();
+  }
+  fz_drop_context(ctx);
+  if (cookie.abort) {
+    debug_msg(DebugRendering, "Rendering aborted:" << page << resolution);
+    return QImage();
   }
-  debug_msg(DebugRendering, "Rendered using MuPDF:" << pixmap->w << pixmap->h
-                                                    << page << resolution);
-  return pixmap;
+  debug_msg(DebugRendering, "Rendered using MuPDF:" << image.size() << page
+                                                    << resolution);
+  return image;
 }
 
 const QPixmap MuPdfRenderer::renderPixmap(const int page,
                                           const qreal resolution) const
 {
-  QPixmap qpixmap;
-  fz_context *ctx = nullptr;
-  if (!doc || !doc->checkResolution(page, resolution)) return qpixmap;
-  fz_pixmap *pixmap = renderFzPixmap(page, resolution, ctx);
-  if (!pixmap || !ctx) return qpixmap;
-
-  // Assume that the pixmap is in RGB colorspace.
-  // Write the pixmap in PNM format to a buffer using MuPDF tools.
-  fz_buffer *buffer = nullptr;
-  fz_output *out = nullptr;
-  fz_var(pixmap);
-  fz_var(buffer);
-  fz_var(out);
-  fz_try(ctx)
-  {
-    buffer = fz_new_buffer(ctx, pixmap->stride * pixmap->y + 16);
-    out = fz_new_output_with_buffer(ctx, buffer);
-    fz_write_pixmap_as_pnm(ctx, out, pixmap);
-  }
-  fz_always(ctx)
-  {
-    fz_drop_output(ctx, out);
-    fz_drop_pixmap(ctx, pixmap);
-  }
-  fz_catch(ctx)
-  {
-    qWarning() << "Fitz failed to write PNM image to buffer:"
-               << fz_caught_message(ctx);
-    fz_drop_buffer(ctx, buffer);
-    fz_drop_context(ctx);
-    return qpixmap;
-  }
+  return QPixmap::fromImage(renderImage(page, resolution));
+}
 
-  // Load the pixmap from buffer in Qt.
-#if (FZ_VERSION_MAJOR > 1) || \
-    ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 17))
-  if (!buffer || !qpixmap.loadFromData(buffer->data, buffer->len, "PNM"))
-    qWarning() << "Failed to load PNM image from buffer";
-#else
-  if (buffer) {
-    unsigned char *buffer_data;
-    const int buffer_size = fz_buffer_storage(ctx, buffer, &buffer_data);
-    qpixmap.loadFromData(buffer_data, buffer_size, "PNM");
-  }
-#endif
-  fz_drop_buffer(ctx, buffer);
-  fz_drop_context(ctx);
-  return qpixmap;
+const QPixmap MuPdfRenderer::renderTile(const int page,
+                                        const qreal resolution,
+                                        const QRect &tile) const
+{
+  return QPixmap::fromImage(renderImage(page, resolution, tile));
 }
 
 const PngPixmap *MuPdfRenderer::renderPng(const int page,
                                           const qreal resolution) const
 {
-  if (!doc || !doc->checkResolution(page, resolution)) return nullptr;
-  fz_context *ctx = nullptr;
-  fz_pixmap *pixmap = renderFzPixmap(page, resolution, ctx);
-  if (!pixmap || !ctx) return nullptr;
-
-  // Save the pixmap to buffer in PNG format.
-  fz_buffer *buffer = nullptr;
-  fz_try(ctx)
-      // Here valgrind complained about "Use of uninitialised value of size 8"
-      buffer = fz_new_buffer_from_pixmap_as_png(ctx, pixmap,
-                                                fz_default_color_params);
-  fz_always(ctx) fz_drop_pixmap(ctx, pixmap);
-  fz_catch(ctx)
-  {
-    qWarning() << "Fitz failed to allocate buffer:" << fz_caught_message(ctx);
-    fz_drop_buffer(ctx, buffer);
-    fz_drop_context(ctx);
-    return nullptr;
-  }
-
-  // Convert the buffer data to QByteArray.
-#if (FZ_VERSION_MAJOR > 1) || \
-    ((FZ_VERSION_MAJOR == 1) && (FZ_VERSION_MINOR >= 17))
-  const QByteArray *data =
-      buffer ? new QByteArray(reinterpret_cast<const char *>(buffer->data),
-                              buffer->len)
-             : nullptr;
-#else
-  const QByteArray *data = nullptr;
-  if (buffer) {
-    unsigned char *buffer_data;
-    const int buffer_size = fz_buffer_storage(ctx, buffer, &buffer_data);
-    data = new QByteArray(reinterpret_cast<const char *>(buffer_data),
-                          buffer_size);
-  }
-#endif
-  fz_drop_buffer(ctx, buffer);
-  fz_drop_context(ctx);
-  return new PngPixmap(data, page, resolution);
+  const QImage image = renderImage(page, resolution);
+  if (image.isNull()) return nullptr;
+  return new PngPixmap(image, page, resolution, preferences()->cache_codec);
 }
@@ -15,6 +15,7 @@ extern "C" {
 #include "src/rendering/abstractrenderer.h"
 #include "src/rendering/mupdfdocument.h"
 
+class QImage;
 class QPixmap;
 class PngPixmap;
 
@@ -31,9 +32,8 @@ class MuPdfRenderer : public AbstractRenderer
   /// Document used for rendering. doc is not owned by this.
   const std::shared_ptr<const MuPdfDocument> doc;
 
-  /// Helper function for rendering functions.
-  fz_pixmap *renderFzPixmap(const int page, const qreal resolution,
-                            fz_context *&ctx) const;
+  /// Cookie for interrupting rendering from another thread.
+  mutable fz_cookie cookie{};
 
  public:
   /// Constructor: only initializes doc and page_part.
@@ -49,6 +49,13 @@ class MuPdfRenderer : public AbstractRenderer
   /// Trivial destructor.
   ~MuPdfRenderer() override {}
 
+  /// Render page to a QImage. MuPDF draws directly to the memory of the
+  /// image. Resolution is given in pixels per point (dpi/72).
+  /// If tile is valid, only this part of the page is rendered.
+  /// @see AbstractRenderer::renderTile()
+  const QImage renderImage(const int page, const qreal resolution,
+                           const QRect &tile = QRect()) const;
+
   /// Render page to a QPixmap. Resolution is given in pixels per point
   /// (dpi/72).
   const QPixmap renderPixmap(const int page,
@@ -59,8 +66,21 @@ class MuPdfRenderer : public AbstractRenderer
   const PngPixmap *renderPng(const int page,
                              const qreal resolution) const override;
 
+  /// Render only a part of the page.
+  const QPixmap renderTile(const int page, const qreal resolution,
+                           const QRect &tile) const override;
+
+  /// MuPDF can render parts of a page.
+  bool supportsTiles() const noexcept override { return true; }
+
   /// In the current implementation this is always valid.
   bool isValid() const override { return doc && doc->isValid(); }
+
+  /// Interrupt rendering using the cookie.
+  void abort() noexcept override { cookie.abort = 1; }
+
+  /// Reset the cookie.
+  void resetAbort() noexcept override { cookie.abort = 0; }
 };
 
 #endif  // MUPDFRENDERER_H
@@ -15,6 +15,81 @@
 #include "src/rendering/qtrenderer.h"
 #endif
 
+void PdfDocument::setPageTable(QVector<QSizeF> sizes,
+                               QVector<QByteArray> hashes,
+                               const QVector<QByteArray> &previous_hashes)
+{
+  const auto old_table = std::atomic_load(&page_table);
+  auto table = std::make_shared<PageTable>();
+  table->flexible =
+      std::any_of(sizes.cbegin(), sizes.cend(),
+                  [&sizes](const QSizeF &size) { return size != sizes[0]; });
+  const int old_pages = old_table ? old_table->sizes.length() : 0;
+  for (int page = 0; page < std::max(old_pages, int(sizes.length())); ++page)
+    if (page >= old_pages || page >= sizes.length() ||
+        old_table->sizes[page] != sizes[page]) {
+      table->resized.append(page);
+      table->changed.append(page);
+    } else if (page >= hashes.length() || page >= previous_hashes.length() ||
+               hashes[page].isEmpty() || hashes[page] != previous_hashes[page])
+      table->changed.append(page);
+  table->sizes = std::move(sizes);
+  table->hashes = std::move(hashes);
+  std::atomic_store(&page_table,
+                    std::shared_ptr<const PageTable>(std::move(table)));
+}
+
+QVector<QByteArray> PdfDocument::storedPageHashes() const
+{
+  const auto table = std::atomic_load(&page_table);
+  return table ? table->hashes : QVector<QByteArray>();
+}
+
+void PdfDocument::setPageHashes(QVector<QByteArray> hashes,
+                                const QVector<QByteArray> &previous_hashes)
+{
+  const auto old_table = std::atomic_load(&page_table);
+  auto table = old_table ? std::make_shared<PageTable>(*old_table)
+                         : std::make_shared<PageTable>();
+  table->changed.clear();
+  for (int page = 0; page < table->sizes.length(); ++page)
+    if (table->resized.contains(page) || page >= hashes.length() ||
+        page >= previous_hashes.length() || hashes[page].isEmpty() ||
+        hashes[page] != previous_hashes[page])
+      table->changed.append(page);
+  // Removed pages are listed after all existing pages.
+  for (const int page : std::as_const(table->resized))
+    if (page >= table->sizes.length()) table->changed.append(page);
+  table->hashes = std::move(hashes);
+  std::atomic_store(&page_table,
+                    std::shared_ptr<const PageTable>(std::move(table)));
+}
+
+const QSizeF PdfDocument::pageSize(const int page) const
+{
+  const auto table = std::atomic_load(&page_table);
+  if (!table || page < 0 || page >= table->sizes.length()) return QSizeF();
+  return table->sizes[page];
+}
+
+bool PdfDocument::flexiblePageSizes() const noexcept
+{
+  const auto table = std::atomic_load(&page_table);
+  return table && table->flexible;
+}
+
+QList<int> PdfDocument::changedPages() const
+{
+  const auto table = std::atomic_load(&page_table);
+  return table ? table->changed : QList<int>();
+}
+
+QList<int> PdfDocument::resizedPages() const
+{
+  const auto table = std::atomic_load(&page_table);
+  return table ? table->resized : QList<int>();
+}
+
 AbstractRenderer *createRenderer(const std::shared_ptr<const PdfDocument> &doc,
                                  const PagePart page_part)
 {
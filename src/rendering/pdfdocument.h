@@ -4,12 +4,16 @@
 #ifndef PDFDOCUMENT_H
 #define PDFDOCUMENT_H
 
+#include <QByteArray>
 #include <QDateTime>
+#include <QList>
 #include <QRectF>
+#include <QSizeF>
 #include <QString>
 #include <QUrl>
 #include <QVector>
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -176,6 +180,29 @@ struct SlideTransition {
   }
 };
 
+/// Text of a page with the bounding box of each character.
+struct PdfPageText {
+  /// Text of the page. Whitespace and line breaks are replaced by single
+  /// spaces.
+  QString text;
+
+  /// Bounding box of each character in text in points. Spaces inserted at
+  /// line breaks have an empty bounding box.
+  QVector<QRectF> boxes;
+
+  /// Append a character (UTF-16 code unit) with its bounding box.
+  /// Consecutive whitespace is collapsed to a single space.
+  void append(const QChar c, const QRectF &box)
+  {
+    if (c.isSpace()) {
+      if (text.isEmpty() || text.back() == ' ') return;
+      text.append(' ');
+    } else
+      text.append(c);
+    boxes.append(box);
+  }
+};
+
 /// Compare outline entries by their page.
 inline bool operator<(const int page, const PdfOutlineEntry &other)
 {
@@ -194,6 +221,25 @@ inline bool operator<(const int page, const PdfOutlineEntry &other)
  */
 class PdfDocument
 {
+  /// Geometry and content of all pages, computed when loading the document.
+  struct PageTable {
+    /// Size of each page in points.
+    QVector<QSizeF> sizes;
+    /// Hash of the content of each page. Empty if unknown.
+    QVector<QByteArray> hashes;
+    /// Pages which changed compared to the previously loaded version.
+    QList<int> changed;
+    /// Pages which were added, removed or changed their size.
+    QList<int> resized;
+    /// Not all pages have the same size.
+    bool flexible = false;
+  };
+
+  /// Page table. The table is never modified but replaced when the
+  /// document is reloaded. Access only via std::atomic_load and
+  /// std::atomic_store, such that reading needs no lock.
+  std::shared_ptr<const PageTable> page_table;
+
  protected:
   /// Modification time of the PDF file.
   QDateTime lastModified;
@@ -201,9 +247,6 @@ class PdfDocument
   /// Path to the PDF file.
   QString path;
 
-  /// 0 if all pages have equal size, 1 otherwise, -1 if unknown.
-  qint8 flexible_page_sizes = -1;
-
   /**
    * @brief list representing the outline tree
    *
@@ -233,12 +276,34 @@ class PdfDocument
   /// Trivial destructor.
   virtual ~PdfDocument() {}
 
+ protected:
+  /// Replace the page table. Must be called by loadDocument() of each
+  /// engine. hashes identify the content of each page after loading and
+  /// previous_hashes the content before reloading. Pages are marked as
+  /// changed if their size or hash differs or if hashes are not available.
+  void setPageTable(QVector<QSizeF> sizes, QVector<QByteArray> hashes = {},
+                    const QVector<QByteArray> &previous_hashes = {});
+
+  /// Content hashes stored in the page table. Empty if unknown.
+  QVector<QByteArray> storedPageHashes() const;
+
+  /// Replace the content hashes in the page table after computing them in
+  /// the background and mark pages as changed if their hash differs from
+  /// previous_hashes or if they were resized. Must not be called
+  /// concurrently with setPageTable().
+  void setPageHashes(QVector<QByteArray> hashes,
+                     const QVector<QByteArray> &previous_hashes);
+
+  /// Pages which were added, removed or resized in the latest load.
+  QList<int> resizedPages() const;
+
+ public:
   /// Load or reload the PDF document if the file has been modified since
   /// it was loaded. Return true if the document was reloaded.
   virtual bool loadDocument() = 0;
 
-  /// Size of page in points (point = inch/72).
-  virtual const QSizeF pageSize(const int page) const = 0;
+  /// Size of page in points (point = inch/72). Empty if page is invalid.
+  const QSizeF pageSize(const int page) const;
 
   /// Number of pages in PDF file.
   virtual int numberOfPages() const = 0;
@@ -299,6 +364,16 @@ class PdfDocument
     return {-1, {}};
   }
 
+  /// Return true if pageText() is implemented for this engine.
+  virtual bool hasPageText() const noexcept { return false; }
+
+  /// Extract text of page with character positions and append it to target.
+  /// This must be thread save. Return false if the text could not be read.
+  virtual bool pageText(const int page, PdfPageText &target) const
+  {
+    return false;
+  }
+
   /// get function for outline
   const QVector<PdfOutlineEntry> &getOutline() const noexcept
   {
@@ -320,6 +395,9 @@ class PdfDocument
     return nullptr;
   }
 
+  /// Target pages of all internal navigation links on given page.
+  virtual QList<int> linkTargets(const int page) const { return {}; }
+
   /// List all video annotations on given page.
   virtual QList<std::shared_ptr<MediaAnnotation>> annotations(const int page)
   {
@@ -336,7 +414,20 @@ class PdfDocument
   }
 
   /// Return true if not all pages in the PDF have the same size.
-  virtual bool flexiblePageSizes() noexcept = 0;
+  bool flexiblePageSizes() const noexcept;
+
+  /// Pages which changed when the document was loaded the last time. This
+  /// includes pages which were removed. All pages are marked as changed if
+  /// the engine cannot compare the content of pages.
+  QList<int> changedPages() const;
+
+  /// Call handler when changedPages() is known for the latest load. The
+  /// default implementation calls handler directly. Engines which compare
+  /// pages in the background may call handler later from a worker thread.
+  virtual void whenChangesKnown(std::function<void()> handler)
+  {
+    handler();
+  }
 
   /// Duration of given page in secons. Default value is -1 is interpreted as
   /// infinity.
@@ -3,30 +3,53 @@
 
 #include "src/rendering/pixcache.h"
 
+#include <QElapsedTimer>
+#include <QFileInfo>
 #include <QPixmap>
 #include <QThread>
 #include <QTimerEvent>
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
 #include "src/config.h"
 #include "src/log.h"
+#include "src/names.h"
 #include "src/rendering/abstractrenderer.h"
 #include "src/rendering/pdfdocument.h"
 #ifdef USE_EXTERNAL_RENDERER
 #include "src/rendering/externalrenderer.h"
 #endif
 #include "src/preferences.h"
+#include "src/rendering/diskcache.h"
+#include "src/rendering/mappedcachefile.h"
 #include "src/rendering/pixcachethread.h"
 #include "src/rendering/pngpixmap.h"
+#include "src/rendering/prefetchpolicy.h"
+#include "src/rendering/renderpool.h"
+#include "src/rendering/renderstats.h"
+
+/// Size of the pixel data of a pixmap in bytes.
+static inline qint64 pixmap_bytes(const QPixmap &pixmap) noexcept
+{
+  return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
 
 PixCache::PixCache(const std::shared_ptr<PdfDocument> &doc,
                    const int thread_number, const PagePart page_part,
                    const CacheMode mode, QObject *parent) noexcept
-    : QObject(parent), priority({page_part}), pdfDoc(doc), cacheMode(mode)
+    : QObject(parent),
+      priority({page_part}),
+      pdfDoc(doc),
+      cacheMode(mode),
+      prefetch(PrefetchPolicy::create(preferences()->prefetch_mode, doc))
 {
   debug_verbose(DebugFunctionCalls, "CREATING PixCache" << this);
-  threads =
-      QVector<PixCacheThread *>(doc->flexiblePageSizes() ? 0 : thread_number);
+  stats = std::make_unique<CacheStats>(
+      QFileInfo(doc->getPath()).fileName() + " (" +
+          get_page_part_names().value(page_part) + ")",
+      renderer_name(preferences()->renderer));
+  threads = QVector<PixCacheThread *>(thread_number);
   threads.fill(nullptr);
 }
 
@@ -53,6 +76,31 @@ void PixCache::init()
 
   // Check if the renderer is valid
   if (!renderer->isValid()) qCritical() << tr("Creating renderer failed");
+  tiles_supported = renderer->supportsTiles();
+
+  if (preferences()->preview_resolution > 0.) {
+#ifdef USE_EXTERNAL_RENDERER
+    if (preferences()->renderer == Renderer::ExternalRenderer)
+      preview_renderer = new ExternalRenderer(
+          preferences()->rendering_command, preferences()->rendering_arguments,
+          pdfDoc, page_part);
+    else
+#endif
+      preview_renderer = createRenderer(pdfDoc, page_part);
+    if (preview_renderer && !preview_renderer->isValid()) {
+      delete preview_renderer;
+      preview_renderer = nullptr;
+    }
+  }
+
+  if (preferences()->global_flags & Preferences::MappedCache) {
+    mapped_file = std::make_unique<MappedCacheFile>();
+    if (!mapped_file->isValid()) mapped_file.reset();
+  }
+
+  if (DiskCache::enabled())
+    disk_cache =
+        std::make_shared<DiskCache>(pdfDoc->getPath(), renderer->pagePart());
 
   // Create threads.
   for (auto &thread : threads) {
@@ -61,6 +109,7 @@ void PixCache::init()
             Qt::QueuedConnection);
     connect(this, &PixCache::setPixCacheThreadPage, thread,
             &PixCacheThread::setNextPage, Qt::QueuedConnection);
+    thread->setDiskCache(disk_cache);
   }
   mutex.unlock();
 }
@@ -68,13 +117,12 @@ void PixCache::init()
 PixCache::~PixCache()
 {
   debug_verbose(DebugFunctionCalls, "DELETING PixCache" << this);
+  // Previews are rendered in the RenderPool with owner this.
+  RenderPool::instance().cancel(this);
+  delete preview_renderer;
   delete renderer;
-  // TODO: correctly clean up threads!
-  for (const auto &thread : std::as_const(threads)) thread->quit();
-  for (const auto &thread : std::as_const(threads)) {
-    thread->wait(10000);
-    delete thread;
-  }
+  // Deleting the threads cancels their jobs in the RenderPool.
+  qDeleteAll(threads);
   mutex.lock();
   clear();
   mutex.unlock();
@@ -83,12 +131,65 @@ PixCache::~PixCache()
 void PixCache::clear()
 {
   debug_verbose(DebugFunctionCalls, this);
+  stale.clear();
+  staleMemory = 0;
+  deferred.clear();
   cache.clear();
+  if (mapped_file) mapped_file->clear();
   usedMemory = 0;
+  decoded.clear();
+  decodedMemory = 0;
+  tiles.clear();
+  stats->setMemory(0, 0);
+  prefetch_queue = predicted;
   region.first = preferences()->page;
   region.second = region.first;
 }
 
+void PixCache::invalidatePages(const QString &path, const QList<int> &pages)
+{
+  debug_verbose(DebugFunctionCalls, path << pages.length() << this);
+  if (path != pdfDoc->getPath()) return;
+  debug_msg(DebugCache, "invalidating" << pages.length() << "pages" << this);
+  mutex.lock();
+  for (const int page : pages) {
+    const auto it = cache.find(page);
+    if (it != cache.end()) {
+      if (it->second) usedMemory -= it->second->size();
+      cache.erase(it);
+    }
+    const auto old = stale.find(page);
+    if (old != stale.end()) {
+      staleMemory -= old->second->size();
+      stale.erase(old);
+    }
+    render_times.erase(page);
+  }
+  for (auto it = decoded.begin(); it != decoded.end();) {
+    if (pages.contains(it->page)) {
+      decodedMemory -= pixmap_bytes(it->pixmap);
+      it = decoded.erase(it);
+    } else
+      ++it;
+  }
+  for (auto it = tiles.begin(); it != tiles.end();) {
+    if (pages.contains(it->page))
+      it = tiles.erase(it);
+    else
+      ++it;
+  }
+  stats->setMemory(usedMemory, decodedMemory);
+  prefetch_queue = predicted;
+  region.first = preferences()->page;
+  region.second = region.first;
+  mutex.unlock();
+  // Images of changed pages which are currently rendered may be outdated.
+  for (const auto thread : std::as_const(threads))
+    if (thread && thread->isRunning() && pages.contains(thread->getPage()))
+      thread->abort();
+  if (thread() == QThread::currentThread()) startTimer(0);
+}
+
 const QPixmap PixCache::pixmap(const int page, qreal resolution)
 {
   // Check if page number is valid.
@@ -98,20 +199,13 @@ const QPixmap PixCache::pixmap(const int page, qreal resolution)
 
   // Try to return a page from cache.
   {
-    mutex.lock();
-    const auto it = cache.find(page);
-    if (it != cache.cend() && it->second &&
-        abs(it->second->getResolution() - resolution) <
-            max_resolution_deviation) {
-      QPixmap pix = it->second->pixmap();
-      if (pix.isNull()) {
-        usedMemory -= it->second->size();
-        cache.erase(it);
-      }
-      mutex.unlock();
-      return pix;
-    }
-    mutex.unlock();
+    const QPixmap pix = lookup(page, resolution);
+    if (!pix.isNull()) return pix;
+  }
+
+  if (disk_cache) {
+    const QPixmap pix = loadFromDisk(page, resolution);
+    if (!pix.isNull()) return pix;
   }
 
   // Check if the renderer is valid
@@ -121,7 +215,12 @@ const QPixmap PixCache::pixmap(const int page, qreal resolution)
   }
 
   debug_msg(DebugCache, "Rendering in main thread");
+  QElapsedTimer timer;
+  timer.start();
   const QPixmap pix = renderer->renderPixmap(page, resolution);
+  const float render_time = timer.elapsed();
+  stats->addLookup(CacheStats::Miss);
+  stats->addRender(page, render_time);
 
   if (pix.isNull()) {
     qCritical() << tr("Rendering page failed for (page, resolution) =") << page
@@ -130,16 +229,16 @@ const QPixmap PixCache::pixmap(const int page, qreal resolution)
   }
 
   // Write pixmap to cache.
-  auto png =
-      std::unique_ptr<const PngPixmap>(new PngPixmap(pix, page, resolution));
-  if (png == nullptr) {
+  auto image = new PngPixmap(pix, page, resolution);
+  image->setRenderTime(render_time);
+  const Frame png(image);
+  if (png->isNull()) {
     qWarning() << "Converting pixmap to PNG failed";
   } else {
+    if (disk_cache) disk_cache->store(png.get());
     mutex.lock();
-    usedMemory += png->size();
-    const auto [it, inserted] = cache.try_emplace(page, nullptr);
-    if (it->second) usedMemory -= it->second->size();
-    it->second.swap(png);
+    insertCache(page, png);
+    insertDecoded(page, resolution, pix);
     mutex.unlock();
   }
   return pix;
@@ -159,7 +258,12 @@ void PixCache::requestRenderPage(const int n)
 void PixCache::pageNumberChanged(const int slide, const int page)
 {
   debug_verbose(DebugFunctionCalls, page << this);
+  // Predict the next pages. This may need to read links from the document.
+  prefetch->pageChanged(slide, page);
+  const QList<int> new_predicted = prefetch->predict(max_predicted_pages);
   mutex.lock();
+  predicted = new_predicted;
+  prefetch_queue = new_predicted;
   // Update boundaries of the simply connected region.
   if (cache.find(page) == cache.end()) {
     // If current page is not yet in cache: make sure it is first in priority
@@ -171,33 +275,59 @@ void PixCache::pageNumberChanged(const int slide, const int page)
     region.first = page;
     region.second = page;
     mutex.unlock();
+    // Navigation jumped to a page which is not cached: free the threads.
+    abortStale(page);
     return;
   }
 
-  // Make sure that current page is inside the region.
-  if (region.first > page || region.second < page) {
-    region.first = page - 1;
-    region.second = page + 1;
-  }
+  // Abort rendering far away pages if page is outside the region.
+  if (region.first > page || region.second < page) abortStale(page);
 
-  // Extend the region as far as possible by searching for gaps.
-  // Use that keys in QMap are sorted and can be accessed by iterators.
-  auto left = std::make_reverse_iterator(cache.find(region.first));
-  auto right = cache.find(region.second);
-  while (left != cache.rend() && left->first == region.first) {
-    ++left;
+  // Recompute the simply connected region of cached pages around page.
+  // Pages inside the previous region may have been removed from cache.
+  const auto current = cache.find(page);
+  auto left = current;
+  region.first = page;
+  while (left != cache.begin() && std::prev(left)->first == region.first - 1) {
+    --left;
     --region.first;
   }
-  while (right != cache.cend() && right->first == region.second) {
-    ++right;
+  --region.first;
+  region.second = page;
+  for (auto right = std::next(current);
+       right != cache.end() && right->first == region.second + 1; ++right)
     ++region.second;
-  }
+  ++region.second;
   mutex.unlock();
 
   // Start rendering next page.
   if (thread() == QThread::currentThread()) startTimer(0);
 }
 
+void PixCache::abortStale(const int page)
+{
+  for (const auto thread : std::as_const(threads)) {
+    if (thread && thread->isRunning() &&
+        (thread->getPage() < page - 1 ||
+         thread->getPage() > page + threads.length()) &&
+        !predicted.contains(thread->getPage()))
+      thread->abort();
+  }
+}
+
+bool PixCache::isRendering(const int page) const
+{
+  for (const auto thread : threads)
+    if (thread && thread->isRunning() && thread->getPage() == page)
+      return true;
+  return false;
+}
+
+bool PixCache::isProtected(const int page) const
+{
+  return page == preferences()->page || predicted.contains(page);
+}
+
 int PixCache::limitCacheSize() noexcept
 {
   debug_verbose(DebugFunctionCalls,
@@ -217,6 +347,17 @@ int PixCache::limitCacheSize() noexcept
 
   const int pref_page = preferences()->page;
   mutex.lock();
+  // Stale pages are removed first, starting with the page farthest away from
+  // the current page.
+  while (!stale.empty() &&
+         ((maxMemory > 0 && usedMemory + staleMemory > maxMemory) ||
+          (maxNumber > 0 && cache.size() + stale.size() > maxNumber))) {
+    const auto first = stale.begin(), last = std::prev(stale.end());
+    const auto victim =
+        pref_page - first->first > last->first - pref_page ? first : last;
+    staleMemory -= victim->second->size();
+    stale.erase(victim);
+  }
   // Check if region is valid.
   if (region.first > region.second) {
     region.first = pref_page;
@@ -261,49 +402,56 @@ int PixCache::limitCacheSize() noexcept
                             << usedMemory << maxMemory << allowed_slides
                             << cached_slides);
 
-  // Deleting starts from first or last page in cache.
-  // The aim is to shrink the cache to a simply connected region
-  // around the current page.
-  int first = cache.cbegin()->first;
-  int last = cache.crbegin()->first;
-  /// Cached page which should be removed.
-  std::unique_ptr<const PngPixmap> remove;
+  // Pages are removed in order of increasing keepScore(): pages which are
+  // cheap to render, large or far away from the current page are removed
+  // first. The current page and predicted pages are never removed.
+  const int direction = prefetch->direction();
+  // Cached pages which are more valuable than the page which would be
+  // rendered next are only removed if this is necessary to satisfy the
+  // limits on memory and number of pages.
+  const qreal next_score = nextRenderScore(pref_page, direction);
+  /// Cached page which should be removed. Lookups which are currently
+  /// decoding this page keep their own reference to it.
+  Frame remove;
 
   // Delete pages while allowed_slides is negative or too small to
   // allow updates.
   do {
-    // If the set of cached pages is simply connected, includes the
-    // current page, and lies mostly ahead of the current page,
-    // then stop rendering to cache.
-    if (((maxNumber < 0 || cache.size() <= maxNumber) &&
-         (maxMemory < 0 || usedMemory <= maxMemory) && last > pref_page &&
-         last - first <= cache.size() && 2 * last + 3 * first > 5 * pref_page)
+    // Find the cached page with the lowest score.
+    auto victim = cache.end();
+    qreal victim_score = 0.;
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+      if (!it->second || isProtected(it->first)) continue;
+      const qreal score =
+          keepScore(it->first, it->second->getRenderTime(),
+                    it->second->size(), pref_page, direction);
+      if (victim == cache.end() || score < victim_score) {
+        victim = it;
+        victim_score = score;
+      }
+    }
+    if (victim == cache.end()
         // the case cache.size() < 2 would lead to segfaults.
-        || cache.size() < 2) {
+        || cache.size() < 2 ||
+        ((maxNumber < 0 || cache.size() <= maxNumber) &&
+         (maxMemory < 0 || usedMemory <= maxMemory) &&
+         victim_score >= next_score)) {
+      // Nothing should be removed: stop rendering to cache.
       mutex.unlock();
       return 0;
     }
 
-    // If more than 3/4 of the cached slides lie ahead of current page, clean up
-    // last.
-    if (last + 3 * first > 4 * pref_page) {
-      const auto it = std::prev(cache.end());
-      remove.swap(it->second);
-      last = std::prev(cache.erase(it))->first;
-    } else {
-      const auto it = cache.begin();
-      remove.swap(it->second);
-      first = cache.erase(it)->first;
-    }
-    // Check if remove is nullptr (which means that a thread is just rendering
-    // it).
-    if (remove == nullptr) continue;
+    remove = std::move(victim->second);
+    cache.erase(victim);
     debug_msg(DebugCache, "removing page from cache"
                               << usedMemory << allowed_slides << cached_slides
-                              << remove->getPage());
+                              << remove->getPage() << victim_score
+                              << next_score);
     // Delete removed cache page and update memory size.
     usedMemory -= remove->size();
     --cached_slides;
+    stats->addEviction();
+    stats->setMemory(usedMemory, decodedMemory);
 
     // Update allowed_slides
     if (usedMemory > 0 && cached_slides > 0) {
@@ -315,10 +463,6 @@ int PixCache::limitCacheSize() noexcept
 
   } while (allowed_slides < threads.length() && cached_slides > 0);
 
-  // Update boundaries of simply connected region
-  if (first > region.first + 1) region.first = first - 1;
-  if (last + 1 < region.second) region.second = last + 1;
-
   mutex.unlock();
   return allowed_slides;
 }
@@ -337,41 +481,289 @@ int PixCache::renderNext()
     }
   }
 
-  const int pref_page = preferences()->page;
+  // Render pages predicted by the prefetch policy.
+  while (!prefetch_queue.isEmpty()) {
+    page = prefetch_queue.takeFirst();
+    if (cache.find(page) == cache.end() && !isRendering(page)) {
+      mutex.unlock();
+      return page;
+    }
+  }
+
   // Check if region is valid.
   if (region.first > region.second) {
-    region.first = pref_page;
+    region.first = preferences()->page;
     region.second = region.first;
   }
+  page = nextRegionPage(region);
+  mutex.unlock();
+  return page;
+}
 
-  // Select region.first or region.second for rendering.
+int PixCache::nextRegionPage(QPair<int, int> &bounds) const
+{
+  const int pref_page = preferences()->page;
+  // Select bounds.first or bounds.second for rendering. Most of the region
+  // should lie in the direction of navigation.
+  const bool forward = prefetch->direction() > 0;
   while (true) {
-    if (region.second + 3 * region.first > 4 * pref_page && region.first >= 0) {
-      if (cache.find(region.first) == cache.end()) {
-        mutex.unlock();
-        return region.first--;
-      }
-      --region.first;
+    if ((forward ? bounds.second + 3 * bounds.first
+                 : 3 * bounds.second + bounds.first) > 4 * pref_page &&
+        bounds.first >= 0) {
+      if (cache.find(bounds.first) == cache.end() &&
+          !isRendering(bounds.first))
+        return bounds.first--;
+      --bounds.first;
     } else {
-      if (cache.find(region.second) == cache.end()) {
-        mutex.unlock();
-        return region.second++;
-      }
-      ++region.second;
+      if (cache.find(bounds.second) == cache.end() &&
+          !isRendering(bounds.second))
+        return bounds.second++;
+      ++bounds.second;
     }
   }
 }
 
+qreal PixCache::keepScore(const int page, const float render_time,
+                          const qint64 size, const int pref_page,
+                          const int direction) noexcept
+{
+  int distance = direction * (page - pref_page);
+  // Pages behind the current page count as 3 times as far away.
+  distance = distance > 0 ? distance : std::max(1, -3 * distance);
+  return (render_time + min_render_time) /
+         (std::max(size, qint64(1)) * distance);
+}
+
+qreal PixCache::nextRenderScore(const int pref_page, const int direction) const
+{
+  // Requested and predicted pages are always rendered.
+  for (const int page : priority)
+    if (cache.find(page) == cache.end()) return INFINITY;
+  for (const int page : prefetch_queue)
+    if (cache.find(page) == cache.end()) return INFINITY;
+
+  QPair<int, int> bounds = region;
+  const int page = nextRegionPage(bounds);
+  if (page < 0 || page >= pdfDoc->numberOfPages()) return 0.;
+
+  // Estimate render time and size of the page.
+  float render_time = 0.f;
+  const auto it = render_times.find(page);
+  if (it != render_times.cend())
+    render_time = it->second;
+  else if (!render_times.empty()) {
+    for (const auto &entry : render_times) render_time += entry.second;
+    render_time /= render_times.size();
+  }
+  const qint64 size = cache.empty() ? 1 : usedMemory / cache.size();
+  return keepScore(page, render_time, size, pref_page, direction);
+}
+
 void PixCache::timerEvent(QTimerEvent *event)
 {
   debug_verbose(DebugFunctionCalls, event << this);
   killTimer(event->timerId());
+  if (event->timerId() == resize_timer) {
+    resize_timer = 0;
+    std::map<int, DeferredRequest> requests;
+    requests.swap(deferred);
+    for (const auto &[page, request] : requests) {
+      const QPixmap pix = lookup(page, request.resolution);
+      if (pix.isNull())
+        renderRequested(page, request.resolution, request.cache);
+      else
+        emit pageReady(pix, page);
+    }
+  }
   startRendering();
+  predecode();
+}
+
+const QPixmap PixCache::lookup(const int page, const qreal resolution)
+{
+  mutex.lock();
+  QPixmap pix = findDecoded(page, resolution);
+  if (!pix.isNull()) {
+    mutex.unlock();
+    stats->addLookup(CacheStats::DecodedHit);
+    return pix;
+  }
+  const auto it = cache.find(page);
+  if (it == cache.cend() || !it->second ||
+      abs(it->second->getResolution() - resolution) >=
+          max_resolution_deviation) {
+    mutex.unlock();
+    return pix;
+  }
+  const Frame frame = it->second;
+  mutex.unlock();
+
+  // Decode without holding the lock. frame stays valid even if the page is
+  // removed from cache in the meantime.
+  pix = decode(*frame);
+  mutex.lock();
+  const auto current = cache.find(page);
+  if (current != cache.cend() && current->second == frame) {
+    if (pix.isNull()) {
+      usedMemory -= frame->size();
+      cache.erase(current);
+      stats->setMemory(usedMemory, decodedMemory);
+    } else
+      insertDecoded(page, resolution, pix);
+  }
+  mutex.unlock();
+  if (!pix.isNull()) stats->addLookup(CacheStats::Hit);
+  return pix;
+}
+
+const QPixmap PixCache::findDecoded(const int page, const qreal resolution)
+{
+  for (int i = 0; i < decoded.length(); ++i) {
+    if (decoded[i].page != page) continue;
+    if (abs(decoded[i].resolution - resolution) >= max_resolution_deviation)
+      return QPixmap();
+    decoded.move(i, 0);
+    return decoded.first().pixmap;
+  }
+  return QPixmap();
+}
+
+void PixCache::insertDecoded(const int page, const qreal resolution,
+                             const QPixmap &pixmap)
+{
+  const int max_pages = preferences()->max_decoded_pages;
+  if (max_pages <= 0 || pixmap.isNull()) return;
+  for (auto it = decoded.begin(); it != decoded.end();) {
+    if (it->page == page) {
+      decodedMemory -= pixmap_bytes(it->pixmap);
+      it = decoded.erase(it);
+    } else
+      ++it;
+  }
+  decoded.prepend({page, resolution, pixmap});
+  decodedMemory += pixmap_bytes(pixmap);
+  while (decoded.length() > max_pages) {
+    decodedMemory -= pixmap_bytes(decoded.last().pixmap);
+    decoded.removeLast();
+  }
+  stats->setMemory(usedMemory, decodedMemory);
+}
+
+void PixCache::insertCache(const int page, Frame png)
+{
+  if (mapped_file) {
+    // Free space in the file by copying all cached pages to the beginning
+    // of the file if most of the file is no longer used.
+    if (mapped_file->size() > 2 * usedMemory + (1 << 26)) compactMappedFile();
+    png = mapFrame(png);
+  }
+  usedMemory += png->size();
+  if (png->getRenderTime() > 0.f) render_times[page] = png->getRenderTime();
+  if (png->getCompressTime() > 0.f)
+    stats->addCompression(png->getCompressTime());
+  const auto [it, inserted] = cache.try_emplace(page, nullptr);
+  if (it->second) usedMemory -= it->second->size();
+  it->second = std::move(png);
+  const auto old = stale.find(page);
+  if (old != stale.end()) {
+    staleMemory -= old->second->size();
+    stale.erase(old);
+  }
+  stats->setMemory(usedMemory, decodedMemory);
+}
+
+PixCache::Frame PixCache::mapFrame(const Frame &png)
+{
+  const QByteArray *data = mapped_file->append(png->getData());
+  if (!data) return png;
+  // The deleter holds a handle to the file, such that the mapped data stays
+  // valid while the frame is used, even after the file has been cleared.
+  return Frame(new PngPixmap(*png, data),
+               [file = mapped_file->handle()](const PngPixmap *frame) {
+                 delete frame;
+               });
+}
+
+void PixCache::compactMappedFile()
+{
+  debug_msg(DebugCache, "compacting cache file" << mapped_file->size()
+                                                << usedMemory << this);
+  // Start a new file and copy all cached pages to it. Frames referencing
+  // the old file keep it alive until they are deleted.
+  mapped_file->clear();
+  for (auto &entry : cache)
+    if (entry.second) entry.second = mapFrame(entry.second);
+}
+
+const QPixmap PixCache::loadFromDisk(const int page, const qreal resolution)
+{
+  QElapsedTimer timer;
+  timer.start();
+  PngPixmap *image = disk_cache->load(page, resolution);
+  if (!image) return QPixmap();
+  image->setRenderTime(timer.elapsed());
+  const Frame png(image);
+  const QPixmap pix = decode(*png);
+  if (pix.isNull()) return pix;
+  stats->addLookup(CacheStats::DiskHit);
+  mutex.lock();
+  insertCache(page, png);
+  insertDecoded(page, resolution, pix);
+  mutex.unlock();
+  return pix;
+}
+
+const QPixmap PixCache::decode(const PngPixmap &png)
+{
+  QElapsedTimer timer;
+  timer.start();
+  const QPixmap pix = png.pixmap();
+  stats->addDecompression(timer.elapsed());
+  return pix;
+}
+
+void PixCache::predecode()
+{
+  const int max_pages = preferences()->max_decoded_pages;
+  if (max_pages <= 0) return;
+  // Candidates in order of decreasing priority: current page, next page,
+  // previous page, ...
+  const int pref_page = preferences()->page;
+  QList<int> candidates;
+  for (int shift = 0; candidates.length() < max_pages && shift <= max_pages;
+       ++shift) {
+    candidates.append(pref_page + shift);
+    if (shift > 0 && candidates.length() < max_pages)
+      candidates.append(pref_page - shift);
+  }
+  // Handle pages with lowest priority first, such that the current page ends
+  // up as most recently used page.
+  for (auto page = candidates.crbegin(); page != candidates.crend(); ++page) {
+    mutex.lock();
+    const auto it = cache.find(*page);
+    if (it == cache.cend() || !it->second ||
+        !findDecoded(*page, it->second->getResolution()).isNull()) {
+      mutex.unlock();
+      continue;
+    }
+    const Frame frame = it->second;
+    mutex.unlock();
+    const QPixmap pix = decode(*frame);
+    if (pix.isNull()) continue;
+    mutex.lock();
+    // Only keep the image if the page was not replaced in the meantime.
+    const auto current = cache.find(*page);
+    if (current != cache.cend() && current->second == frame)
+      insertDecoded(*page, frame->getResolution(), pix);
+    mutex.unlock();
+  }
 }
 
 void PixCache::startRendering()
 {
   debug_verbose(DebugCache | DebugFunctionCalls, "Start rendering" << this);
+  // Wait until the frame size is known and stable.
+  if (resize_timer != 0 || frame.isEmpty()) return;
   // Clean up cache and check if there is enough space for more cached pages.
   int allowed_pages = limitCacheSize();
   if (allowed_pages <= 0) return;
@@ -394,8 +786,14 @@ void PixCache::receiveData(const PngPixmap *data)
     return;
   }
 
+  // An aborted thread sends nullptr and can render the next page.
+  if (data == nullptr) {
+    startTimer(0);
+    return;
+  }
+
   // If a renderer failed, it should already have sent an error message.
-  if (data == nullptr || data->isNull()) {
+  if (data->isNull()) {
     delete data;
     return;
   }
@@ -418,10 +816,8 @@ void PixCache::receiveData(const PngPixmap *data)
     }
     delete data;
   } else {
-    usedMemory += data->size();
-    const auto [it, inserted] = cache.try_emplace(data->getPage(), nullptr);
-    if (it->second) usedMemory -= it->second->size();
-    it->second.reset(data);
+    stats->addRender(data->getPage(), data->getRenderTime());
+    insertCache(data->getPage(), Frame(data));
   }
   mutex.unlock();
 
@@ -453,20 +849,63 @@ qreal PixCache::getResolution(const int page) const
   }
 }
 
+void PixCache::setSlideOrder(const QList<int> &order)
+{
+  prefetch->setSlideOrder(order);
+}
+
 void PixCache::updateFrame(const QSizeF &size)
 {
   debug_verbose(DebugFunctionCalls, size << frame << this);
-  if (frame != size && threads.length() > 0) {
-    debug_msg(DebugCache, "update frame" << frame << size);
-    mutex.lock();
-    if ((cacheMode == FitWidth && frame.width() == size.width()) ||
-        (cacheMode == FitHeight && frame.height() == size.height())) {
-      frame = size;
-    } else {
-      frame = size;
-      clear();
+  if (frame == size) return;
+  debug_msg(DebugCache, "update frame" << frame << size);
+  mutex.lock();
+  frame = size;
+  // Only pages which need a different resolution in the new frame are
+  // removed. For documents with flexible page sizes or in FitWidth and
+  // FitHeight mode this may keep some or all pages. Removed pages are kept
+  // as fallback until they are rendered again.
+  bool changed = false;
+  for (auto it = cache.begin(); it != cache.end();) {
+    const int page = it->first;
+    Frame &png = it->second;
+    if (png && abs(png->getResolution() - getResolution(page)) <
+                   max_resolution_deviation) {
+      ++it;
+      continue;
     }
-    mutex.unlock();
+    if (png) {
+      usedMemory -= png->size();
+      const auto [old, inserted] = stale.try_emplace(page, nullptr);
+      if (old->second) staleMemory -= old->second->size();
+      staleMemory += png->size();
+      old->second = std::move(png);
+    }
+    it = cache.erase(it);
+    changed = true;
+  }
+  for (auto it = decoded.begin(); it != decoded.end();) {
+    if (abs(it->resolution - getResolution(it->page)) <
+        max_resolution_deviation)
+      ++it;
+    else {
+      decodedMemory -= pixmap_bytes(it->pixmap);
+      it = decoded.erase(it);
+    }
+  }
+  stats->setMemory(usedMemory, decodedMemory);
+  if (changed) {
+    prefetch_queue = predicted;
+    region.first = preferences()->page;
+    region.second = region.first;
+  }
+  const bool has_stale = changed && !stale.empty();
+  mutex.unlock();
+  // Delay rendering until the size is stable, e.g. while the window is
+  // resized interactively.
+  if (has_stale && thread() == QThread::currentThread()) {
+    if (resize_timer != 0) killTimer(resize_timer);
+    resize_timer = startTimer(resize_delay);
   }
 }
 
@@ -478,33 +917,54 @@ void PixCache::requestPage(const int page, const qreal resolution,
   if (page < 0 || resolution <= 0) return;
   // Try to return a page from cache.
   {
-    mutex.lock();
-    const auto it = cache.find(page);
-    debug_verbose(DebugCache,
-                  "searched for page"
-                      << page << (it == cache.cend())
-                      << (it != cache.cend() && it->second != nullptr)
-                      << (it == cache.cend()
-                              ? -1024
-                              : (it->second->getResolution() - resolution)));
-    if (it != cache.cend() && it->second &&
-        abs(it->second->getResolution() - resolution) <
-            max_resolution_deviation) {
-      QPixmap pix = it->second->pixmap();
-      if (pix.isNull()) {
-        usedMemory -= it->second->size();
-        cache.erase(it);
-      }
-      mutex.unlock();
+    const QPixmap pix = lookup(page, resolution);
+    if (!pix.isNull()) {
+      debug_verbose(DebugCache, "found cached page" << page);
       emit pageReady(pix, page);
       return;
     }
-    mutex.unlock();
   }
   // Check if page number is valid.
   if (page < 0 || page >= pdfDoc->numberOfPages()) return;
 
-  // Render new page.
+  if (disk_cache) {
+    const QPixmap pix = loadFromDisk(page, resolution);
+    if (!pix.isNull()) {
+      emit pageReady(pix, page);
+      return;
+    }
+  }
+
+  // Show the page rendered for the previous frame size. While the frame
+  // size is changing, rendering is delayed.
+  if (sendStale(page, resolution) && resize_timer != 0) {
+    deferred[page] = {resolution, cache_page};
+    return;
+  }
+
+  renderRequested(page, resolution, cache_page);
+}
+
+bool PixCache::sendStale(const int page, const qreal resolution)
+{
+  mutex.lock();
+  const auto it = stale.find(page);
+  const Frame frame = it == stale.cend() ? nullptr : it->second;
+  mutex.unlock();
+  if (!frame) return false;
+  const QPixmap pix = decode(*frame);
+  if (pix.isNull()) return false;
+  debug_msg(DebugCache, "sending stale page" << page << frame->getResolution()
+                                             << resolution);
+  const QSize size = pix.size() * (resolution / frame->getResolution());
+  emit previewReady(
+      pix.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation), page);
+  return true;
+}
+
+void PixCache::renderRequested(const int page, const qreal resolution,
+                               const bool cache_page)
+{
   // Check if the renderer is valid
   if (renderer == nullptr || !renderer->isValid()) {
     qCritical() << tr("Invalid renderer");
@@ -512,7 +972,12 @@ void PixCache::requestPage(const int page, const qreal resolution,
   }
 
   debug_msg(DebugCache, "Rendering page in PixCache thread" << this);
+  QElapsedTimer timer;
+  timer.start();
   const QPixmap pix = renderer->renderPixmap(page, resolution);
+  const float render_time = timer.elapsed();
+  stats->addLookup(CacheStats::Miss);
+  stats->addRender(page, render_time);
 
   if (pix.isNull()) {
     qCritical() << tr("Rendering page failed for (page, resolution) =") << page
@@ -524,18 +989,21 @@ void PixCache::requestPage(const int page, const qreal resolution,
   }
 
   emit pageReady(pix, page);
+  // A queued preview is no longer needed.
+  if (preview_renderer) RenderPool::instance().remove(this);
 
   if (cache_page) {
     // Write pixmap to cache.
-    std::unique_ptr<const PngPixmap> png(new PngPixmap(pix, page, resolution));
-    if (png == nullptr)
+    auto image = new PngPixmap(pix, page, resolution);
+    image->setRenderTime(render_time);
+    const Frame png(image);
+    if (png->isNull())
       qWarning() << "Converting pixmap to PNG failed";
     else {
+      if (disk_cache) disk_cache->store(png.get());
       mutex.lock();
-      usedMemory += png->size();
-      const auto [it, inserted] = cache.try_emplace(page, nullptr);
-      if (it->second) usedMemory -= it->second->size();
-      it->second.swap(png);
+      insertCache(page, png);
+      insertDecoded(page, resolution, pix);
       debug_verbose(DebugCache, "writing page to cache" << page << usedMemory);
       mutex.unlock();
     }
@@ -545,6 +1013,96 @@ void PixCache::requestPage(const int page, const qreal resolution,
   if (thread() == QThread::currentThread()) startTimer(0);
 }
 
+void PixCache::requestTile(const int page, const qreal resolution,
+                           const QPoint index)
+{
+  const int size = preferences()->tile_size;
+  if (size <= 0 || page < 0 || page >= pdfDoc->numberOfPages() ||
+      resolution <= 0.)
+    return;
+  mutex.lock();
+  for (int i = 0; i < tiles.length(); ++i) {
+    const Tile &tile = tiles[i];
+    if (tile.page == page && tile.index == index &&
+        abs(tile.resolution - resolution) < max_resolution_deviation) {
+      tiles.move(i, 0);
+      const QPixmap pix = tiles.first().pixmap;
+      mutex.unlock();
+      emit tileReady(pix, page, resolution, index);
+      return;
+    }
+  }
+  mutex.unlock();
+
+  if (renderer == nullptr || !renderer->isValid()) {
+    qCritical() << tr("Invalid renderer");
+    return;
+  }
+  debug_msg(DebugCache, "Rendering tile" << page << resolution << index);
+  const QPixmap pix =
+      renderer->renderTile(page, resolution, {index * size, QSize(size, size)});
+  // Also send null pixmaps, such that views stop waiting for this tile.
+  emit tileReady(pix, page, resolution, index);
+  if (pix.isNull()) return;
+  mutex.lock();
+  tiles.prepend({page, resolution, index, pix});
+  while (tiles.length() > preferences()->max_tiles) tiles.removeLast();
+  mutex.unlock();
+}
+
+void PixCache::requestPreview(const int page, const qreal resolution)
+{
+  const qreal factor = preferences()->preview_resolution;
+  if (factor <= 0. || page < 0 || page >= pdfDoc->numberOfPages() ||
+      resolution <= 0.)
+    return;
+  mutex.lock();
+  // No preview is required if the page is already decoded or if a stale
+  // page is available, which is sent by requestPage().
+  if (!findDecoded(page, resolution).isNull() ||
+      stale.find(page) != stale.cend()) {
+    mutex.unlock();
+    return;
+  }
+  const auto it = cache.find(page);
+  Frame frame;
+  if (it != cache.cend() && it->second) {
+    // No preview is required if the page is cached.
+    if (abs(it->second->getResolution() - resolution) <
+        max_resolution_deviation) {
+      mutex.unlock();
+      return;
+    }
+    // Use cached image with different resolution as preview.
+    frame = it->second;
+  }
+  mutex.unlock();
+  if (frame) {
+    const QPixmap pix = decode(*frame);
+    if (!pix.isNull()) {
+      emit previewReady(pix, page);
+      return;
+    }
+  }
+
+  // Render the preview in the RenderPool, such that the full resolution page
+  // can be rendered in this thread at the same time. Only the latest preview
+  // is of interest, older queued previews are dropped.
+  if (preview_renderer == nullptr) return;
+  RenderPool &pool = RenderPool::instance();
+  pool.remove(this);
+  const qreal preview_resolution = factor * resolution;
+  pool.submit(this, RenderPool::VisiblePage,
+              [this, page, preview_resolution]() {
+                QMutexLocker locker(&preview_mutex);
+                debug_msg(DebugCache,
+                          "Rendering preview" << page << preview_resolution);
+                const QPixmap pix =
+                    preview_renderer->renderPixmap(page, preview_resolution);
+                if (!pix.isNull()) emit previewReady(pix, page);
+              });
+}
+
 void PixCache::getPixmap(const int page, QPixmap &target, qreal resolution)
 {
   debug_verbose(DebugFunctionCalls, page << resolution << this);
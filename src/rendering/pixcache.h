@@ -9,8 +9,11 @@
 #include <QMutex>
 #include <QObject>
 #include <QPair>
+#include <QPixmap>
+#include <QPoint>
 #include <QSizeF>
 #include <QVector>
+#include <atomic>
 #include <map>
 #include <memory>
 
@@ -19,11 +22,14 @@
 #include "src/log.h"
 #include "src/rendering/pngpixmap.h"
 
-class QPixmap;
 class QTimerEvent;
 class PdfDocument;
 class PixCacheThread;
 class AbstractRenderer;
+class DiskCache;
+class MappedCacheFile;
+class PrefetchPolicy;
+class CacheStats;
 
 /**
  * @brief Cache of compressed slides as PNG images.
@@ -48,12 +54,75 @@ class PixCache : public QObject
  private:
   static constexpr qreal max_resolution_deviation = 1e-5;
 
+  /// Maximum number of pages predicted by the prefetch policy.
+  static constexpr int max_predicted_pages = 6;
+
+  /// Time in ms after the latest change of the frame size before pages are
+  /// rendered with the new resolution.
+  static constexpr int resize_delay = 200;
+
+  /// Render time in ms added to the measured render time of each page when
+  /// comparing the costs of pages. Avoids overrating very fast pages.
+  static constexpr float min_render_time = 10.f;
+
+  /// Cached compressed page. Frames are immutable and reference counted:
+  /// lookups take a reference while mutex is locked and decode the frame
+  /// after unlocking. Removing a page from cache never invalidates a frame
+  /// which is still being decoded.
+  using Frame = std::shared_ptr<const PngPixmap>;
+
+  /// Decoded page image which can be shown without decompression.
+  struct DecodedPage {
+    int page;
+    qreal resolution;
+    QPixmap pixmap;
+  };
+
+  /// Tile of a page rendered with enlarged resolution.
+  struct Tile {
+    int page;
+    qreal resolution;
+    QPoint index;
+    QPixmap pixmap;
+  };
+
+  /// Recently rendered tiles, most recently used first. The length is
+  /// limited by preferences()->max_tiles.
+  QList<Tile> tiles;
+
   /// Map page numbers to cached PNG pixmaps.
   /// Pages which are currently being rendered are marked with a nullptr here.
-  /// std::map seems better than QMap for handling std::unique_ptr
-  std::map<int, std::unique_ptr<const PngPixmap>> cache;
+  std::map<int, Frame> cache;
+
+  /// Pages cached for a previous frame size. These are shown as rescaled
+  /// previews until the page is cached with the new resolution.
+  std::map<int, Frame> stale;
+
+  /// Size of all frames in stale in bytes.
+  qint64 staleMemory = 0;
+
+  /// Request for a page which is rendered when the frame size is stable.
+  struct DeferredRequest {
+    qreal resolution;
+    bool cache;
+  };
+
+  /// Pages requested while the frame size was changing.
+  std::map<int, DeferredRequest> deferred;
 
-  /// Mutex to lock this thread.
+  /// Timer started when the frame size changes. While it is active, no
+  /// pages are rendered for which a stale page is available. 0 if inactive.
+  int resize_timer = 0;
+
+  /// Decoded images of pages close to the current page, most recently used
+  /// pages first. The length is limited by preferences()->max_decoded_pages.
+  QList<DecodedPage> decoded;
+
+  /// Size of all pixmaps in decoded in bytes.
+  qint64 decodedMemory = 0;
+
+  /// Mutex to lock this thread. Decoding images must not happen while this
+  /// is locked.
   QMutex mutex;
 
   /// List of pages which should be rendered next.
@@ -62,6 +131,13 @@ class PixCache : public QObject
   /// Boundaries of simply connected region of cache containing current page.
   QPair<int, int> region{INT_MAX, -1};
 
+  /// Pages predicted to be shown next, most likely first. These are not
+  /// removed from cache.
+  QList<int> predicted;
+
+  /// Predicted pages which have not yet been considered for rendering.
+  QList<int> prefetch_queue;
+
   /// Size in which the slides should be rendered.
   /// @todo make sure this is updated.
   QSizeF frame;
@@ -72,32 +148,88 @@ class PixCache : public QObject
   /// Current size in bytes
   qint64 usedMemory = 0;
 
+  /// Last measured render time in ms for each page, also for pages which
+  /// have been removed from cache. Used to estimate the cost of rendering a
+  /// page (again).
+  std::map<int, float> render_times;
+
   /// Maximum number of slides in cache
   int maxNumber = -1;
 
   /// Fixed width for cache in scroll mode
   CacheMode cacheMode = FitPage;
 
-  /// Threads used to render pages to cache.
-  /// This will be an empty vector if the PDF has flexible page sizes.
+  /// Threads used to render pages to cache. Each job gets the resolution of
+  /// its page, such that this also works for flexible page sizes.
   QVector<PixCacheThread *> threads;
 
   /// Own renderer for rendering in PixCache thread.
   AbstractRenderer *renderer{nullptr};
 
+  /// Renderer for low resolution previews, used in the RenderPool.
+  /// nullptr if previews are disabled.
+  AbstractRenderer *preview_renderer{nullptr};
+
+  /// True if renderer can render tiles without rendering the full page.
+  /// Set in init().
+  std::atomic<bool> tiles_supported{false};
+
+  /// Lock for preview_renderer, such that only one preview is rendered at
+  /// a time.
+  QMutex preview_mutex;
+
   /// Pdf document.
   std::shared_ptr<const PdfDocument> pdfDoc;
 
-  /// Check cache size and delete pages if necessary.
+  /// Strategy for predicting the next pages.
+  std::unique_ptr<PrefetchPolicy> prefetch;
+
+  /// Counters and histograms, registered in RenderStats.
+  std::unique_ptr<CacheStats> stats;
+
+  /// File to which compressed pages are moved if the MappedCache flag is
+  /// set in preferences. nullptr otherwise.
+  std::unique_ptr<MappedCacheFile> mapped_file;
+
+  /// Cache on disk, shared with threads. nullptr if disabled.
+  std::shared_ptr<DiskCache> disk_cache;
+
+  /// Check cache size and delete pages with the lowest keepScore() if
+  /// necessary.
   /// Return estimated number of pages which still fit in cache.
   /// Return INT_MAX >> 1 if cache is unlimited or empty.
   int limitCacheSize() noexcept;
 
+  /// Abort rendering in all threads which render pages far away from page
+  /// and which are not predicted.
+  void abortStale(const int page);
+
+  /// Check whether one of the threads is rendering page.
+  bool isRendering(const int page) const;
+
+  /// Check whether page should not be removed from cache.
+  bool isProtected(const int page) const;
+
   /// Choose a page which should be rendered next.
   /// The page is then marked as "being rendered".
   /// This page must then also be rendered.
   int renderNext();
 
+  /// Find the next page outside bounds which is neither cached nor being
+  /// rendered and move the bound beyond this page. bounds should be region
+  /// or a copy of it. mutex must be locked.
+  int nextRegionPage(QPair<int, int> &bounds) const;
+
+  /// Value of keeping a page in cache: render time per byte divided by the
+  /// distance from the current page in direction of navigation.
+  static qreal keepScore(const int page, const float render_time,
+                         const qint64 size, const int pref_page,
+                         const int direction) noexcept;
+
+  /// Estimated keepScore of the page which would be rendered next.
+  /// Infinite for requested or predicted pages. mutex must be locked.
+  qreal nextRenderScore(const int pref_page, const int direction) const;
+
   /// Calculate resolution for given page number based on this->frame.
   /// Return resolution in pixels per point (72*dpi)
   qreal getResolution(const int page) const;
@@ -105,8 +237,55 @@ class PixCache : public QObject
   /// Get pixmap showing page and write it to cache.
   const QPixmap pixmap(const int page, qreal resolution = -1.);
 
+  /// Render requested page, emit pageReady and write it to cache if
+  /// cache_page is true.
+  void renderRequested(const int page, const qreal resolution,
+                       const bool cache_page);
+
+  /// Send the stale page rescaled to resolution as preview. Return false if
+  /// no stale page is available. mutex must not be locked.
+  bool sendStale(const int page, const qreal resolution);
+
+  /// Find page with given resolution in decoded and mark it as recently used.
+  /// Return a null pixmap if the page is not found. mutex must be locked.
+  const QPixmap findDecoded(const int page, const qreal resolution);
+
+  /// Insert pixmap as most recently used page in decoded and limit the
+  /// number of decoded pages. mutex must be locked.
+  void insertDecoded(const int page, const qreal resolution,
+                     const QPixmap &pixmap);
+
+  /// Write png to cache (moving its data to mapped_file if available) and
+  /// update usedMemory. mutex must be locked.
+  void insertCache(const int page, Frame png);
+
+  /// Copy png to mapped_file. The returned frame keeps the file mapped as
+  /// long as it exists. Return png if copying fails. mutex must be locked.
+  Frame mapFrame(const Frame &png);
+
+  /// Get page with given resolution from decoded or cache, decoding it if
+  /// necessary. Return a null pixmap if the page is not cached.
+  /// mutex must not be locked.
+  const QPixmap lookup(const int page, const qreal resolution);
+
+  /// Rewrite all cached pages to mapped_file, dropping data of removed pages.
+  /// mutex must be locked.
+  void compactMappedFile();
+
+  /// Load page from disk cache and write it to cache. Return a null pixmap
+  /// if the page is not found on disk. mutex must not be locked.
+  const QPixmap loadFromDisk(const int page, const qreal resolution);
+
+  /// Decompress png and record the time needed for this in stats.
+  const QPixmap decode(const PngPixmap &png);
+
+  /// Decode cached pages around the current page which are not yet decoded.
+  void predecode();
+
  protected:
-  /// Timer event: stop the timer and start rendering next pixmap.
+  /// Timer event: stop the timer, start rendering next pixmap and decode
+  /// pages around the current page. When the resize timer stops, deferred
+  /// requests are rendered first.
   void timerEvent(QTimerEvent *event) override;
 
  public:
@@ -155,9 +334,15 @@ class PixCache : public QObject
   /// Total size of all cached pages in bytes
   qint64 getUsedMemory() const noexcept { return usedMemory; }
 
+  /// Total size of all decoded pages in bytes
+  qint64 getDecodedMemory() const noexcept { return decodedMemory; }
+
   /// Number of pixels per page (maximum)
   float getPixels() const noexcept { return frame.width() * frame.height(); }
 
+  /// Check whether enlarged pages can be rendered in tiles.
+  bool supportsTiles() const noexcept { return tiles_supported; }
+
  public slots:
   /// Set memory based on scale factor (bytes per pixel).
   void setScaledMemory(const float scale)
@@ -166,18 +351,26 @@ class PixCache : public QObject
     setMaxMemory(scale * frame.width() * frame.height());
   }
 
-  /// Udate frame and clear cache if necessary.
-  /// Cache will only be cleared if !threads.isEmpty(), because an empty
-  /// thread vector indicates flexible slide size.
+  /// Set page index for each slide, used to predict the next pages.
+  /// May only be called in this object's thread.
+  void setSlideOrder(const QList<int> &order);
+
+  /// Udate frame and remove pages from cache which need a different
+  /// resolution in the new frame. Removed pages are kept as stale pages and
+  /// rendering is delayed until the frame size is stable.
   void updateFrame(QSizeF const &size);
 
   /// Create renderCacheTimer.
   /// This is an own function because it must be done in this thread.
   void init();
 
-  /// Clear cache, delete all cached pages.
+  /// Clear cache, delete all cached and stale pages.
   void clear();
 
+  /// Remove the given pages from cache after the document at path has been
+  /// reloaded. Does nothing if this caches a different document.
+  void invalidatePages(const QString &path, const QList<int> &pages);
+
   /// Request rendering a page with high priority
   /// May only be called in this object's thread.
   void requestPage(const int n, const qreal resolution,
@@ -187,6 +380,18 @@ class PixCache : public QObject
   /// Additionally write pixmap to cache if it needs to be created.
   void getPixmap(const int page, QPixmap &target, qreal resolution = -1.);
 
+  /// Render tile of a page with enlarged resolution or take it from cache.
+  /// index is the position of the tile in units of preferences()->tile_size.
+  /// Emits tileReady. May only be called in this object's thread.
+  void requestTile(const int page, const qreal resolution, const QPoint index);
+
+  /// Send a preview of page if it is not cached with the given resolution.
+  /// The preview is a cached image of the page with different resolution
+  /// or is rendered with reduced resolution in the RenderPool, such that
+  /// rendering the full resolution page is not delayed.
+  /// May only be called in this object's thread.
+  void requestPreview(const int page, const qreal resolution);
+
   /// Request rendering a page with low priority
   /// May only be called in this object's thread.
   void requestRenderPage(const int n);
@@ -194,7 +399,8 @@ class PixCache : public QObject
   /// Start rendering the next page(s).
   void startRendering();
 
-  /// Receive a PngPixmap from one of the threads.
+  /// Receive a PngPixmap from one of the threads. data is nullptr if the
+  /// thread was aborted.
   /// May only be called in this object's thread.
   void receiveData(const PngPixmap *data);
 
@@ -209,6 +415,13 @@ class PixCache : public QObject
   /// Send out new page.
   void pageReady(const QPixmap pixmap, const int page);
 
+  /// Send out preview of a page.
+  void previewReady(const QPixmap pixmap, const int page);
+
+  /// Send out a tile. pixmap is null if rendering failed.
+  void tileReady(const QPixmap pixmap, const int page, const qreal resolution,
+                 const QPoint index);
+
   /// Notify target thread that it should work on given page.
   void setPixCacheThreadPage(const PixCacheThread *target,
                              const int page_number, const qreal res);
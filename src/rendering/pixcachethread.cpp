@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
 // SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
 
+#include <QElapsedTimer>
+
 #include "src/config.h"
 #include "src/rendering/pdfdocument.h"
 #ifdef USE_EXTERNAL_RENDERER
@@ -8,36 +10,89 @@
 #endif
 #include "src/log.h"
 #include "src/preferences.h"
+#include "src/rendering/diskcache.h"
 #include "src/rendering/pixcachethread.h"
 #include "src/rendering/pngpixmap.h"
+#include "src/rendering/renderpool.h"
+
+PixCacheThread::~PixCacheThread()
+{
+  RenderPool::instance().cancel(this);
+  delete renderer;
+}
 
 void PixCacheThread::setNextPage(const PixCacheThread *target,
                                  const int page_number, const qreal res)
 {
-  if (target == this && !isRunning()) {
-    page = page_number;
-    resolution = res;
-    start(QThread::LowPriority);
-  }
+  if (target != this || busy.exchange(true)) return;
+  page = page_number;
+  resolution = res;
+  const int current_page = preferences()->page;
+  const RenderPool::Priority priority =
+      page == current_page       ? RenderPool::VisiblePage
+      : page == current_page + 1 ? RenderPool::NextPage
+                                 : RenderPool::Prefetch;
+  const unsigned int job_epoch = epoch;
+  RenderPool::instance().submit(this, priority, [this, job_epoch]() {
+    const PngPixmap *image = render(job_epoch);
+    // Discard the result if this has been aborted while rendering.
+    const bool aborted = epoch != job_epoch;
+    if (image && aborted) {
+      delete image;
+      image = nullptr;
+    }
+    // Mark this as available before PixCache receives the image and
+    // starts rendering the next page.
+    busy = false;
+    // Send the image to pixcache master. After an abort, a null image tells
+    // PixCache that this is available again.
+    if (image || aborted) emit sendData(image);
+  });
 }
 
-void PixCacheThread::run()
+void PixCacheThread::abort()
 {
-  if (this != QThread::currentThread()) {
-    qCritical() << "Called PixCacheThread::run from wrong thread!";
-    return;
-  }
+  if (!busy) return;
+  debug_msg(DebugCache, "aborting rendering of page" << page << this);
+  ++epoch;
+  // If the job is still queued, it is removed and this is available again.
+  if (RenderPool::instance().remove(this) > 0)
+    busy = false;
+  else if (renderer)
+    renderer->abort();
+}
 
+const PngPixmap *PixCacheThread::render(const unsigned int job_epoch)
+{
   // Check if a renderer is available.
-  if (renderer == nullptr || resolution <= 0. || page < 0) return;
+  if (renderer == nullptr || resolution <= 0. || page < 0) return nullptr;
+
+  // Check if this job is still wanted. The abort flag of the renderer must
+  // be reset before checking the epoch to avoid missing an abort request.
+  renderer->resetAbort();
+  if (epoch != job_epoch) return nullptr;
+
+  // Measure the time needed to load or render the page.
+  QElapsedTimer timer;
+  timer.start();
+
+  // Check if the page has been rendered before.
+  if (disk_cache) {
+    PngPixmap *image = disk_cache->load(page, resolution);
+    if (image) {
+      image->setRenderTime(timer.elapsed());
+      return image;
+    }
+  }
 
   // Render the image. This is takes some time.
   debug_msg(DebugCache,
             "Rendering in cache thread:" << page << resolution << this);
-  auto image = renderer->renderPng(page, resolution);
-
-  // Send the image to pixcache master.
-  if (image) emit sendData(image);
+  const PngPixmap *image = renderer->renderPng(page, resolution);
+  // The image was just created by the renderer and is not shared yet.
+  if (image) const_cast<PngPixmap *>(image)->setRenderTime(timer.elapsed());
+  if (image && disk_cache) disk_cache->store(image);
+  return image;
 }
 
 bool PixCacheThread::initializeRenderer(
@@ -4,7 +4,8 @@
 #ifndef PIXCACHETHREAD_H
 #define PIXCACHETHREAD_H
 
-#include <QThread>
+#include <QObject>
+#include <atomic>
 #include <memory>
 
 #include "src/config.h"
@@ -13,11 +14,16 @@
 
 class PngPixmap;
 class PdfDocument;
+class DiskCache;
 
 /**
- * @brief Separate thread for rendering page pixmaps to (compressed) cache.
+ * @brief Renderer for rendering page pixmaps to (compressed) cache.
+ *
+ * The name is historical: This object does not own a thread. Instead it
+ * submits its jobs to the global RenderPool. Each object renders at most
+ * one page at a time with its own renderer.
  */
-class PixCacheThread : public QThread
+class PixCacheThread : public QObject
 {
   Q_OBJECT
 
@@ -31,34 +37,62 @@ class PixCacheThread : public QThread
   /// page number (index)
   int page = -1;
 
+  /// True while a job of this is queued or running in the RenderPool.
+  std::atomic<bool> busy{false};
+
+  /// Generation of jobs, incremented by abort(). Jobs of an older
+  /// generation are skipped or their result is discarded.
+  std::atomic<unsigned int> epoch{0};
+
+  /// Optional cache on disk, shared with the PixCache owning this thread.
+  std::shared_ptr<DiskCache> disk_cache;
+
+  /// Do the work: load or render the page. Called by a thread of the
+  /// RenderPool. Return nullptr if job_epoch is outdated.
+  /// The caller takes ownership of the returned object.
+  const PngPixmap *render(const unsigned int job_epoch);
+
  public:
-  /// Constructor: initialize thread and renderer.
+  /// Constructor: initialize renderer.
   PixCacheThread(const std::shared_ptr<const PdfDocument> &doc,
                  const PagePart page_part = FullPage, QObject *parent = nullptr)
-      : QThread(parent)
+      : QObject(parent)
   {
     initializeRenderer(doc, page_part);
   }
 
-  /// Destructor: delete renderer.
-  ~PixCacheThread() { delete renderer; }
+  /// Destructor: cancel rendering, delete renderer.
+  ~PixCacheThread();
 
   /// Create a renderer based on preferences.
   /// Return true if successful and false if no renderer was created.
   bool initializeRenderer(const std::shared_ptr<const PdfDocument> &doc,
                           const PagePart page_part = FullPage);
 
-  /// Do the work: renderer to actually renders the page. Emits sendData.
-  void run() override;
+  /// Set cache on disk which is checked before rendering a page.
+  void setDiskCache(const std::shared_ptr<DiskCache> &cache)
+  {
+    disk_cache = cache;
+  }
+
+  /// Check whether this is currently rendering a page.
+  bool isRunning() const noexcept { return busy; }
+
+  /// Page which is currently or was last rendered.
+  int getPage() const noexcept { return page; }
+
+  /// Cancel the queued job or interrupt the running job. The result of the
+  /// current job will not be sent.
+  void abort();
 
  public slots:
-  /// Set page number and resolution, then start the thread.
+  /// Set page number and resolution, then submit the job to the RenderPool.
   /// Only has an effect if target==this and if this is not running.
   void setNextPage(const PixCacheThread *target, const int page_number,
                    const qreal res);
 
  signals:
-  /// Send out the data.
+  /// Send out the data. data is nullptr if the job was aborted.
   void sendData(const PngPixmap *data);
 };
 
@@ -3,18 +3,38 @@
 
 #include "src/rendering/pngpixmap.h"
 
+#include <zlib.h>
+
 #include <QBuffer>
 #include <QByteArray>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QImage>
 #include <QPixmap>
 #include <QtDebug>
+#include <cstring>
+
+#include "src/names.h"
+#include "src/preferences.h"
 
 PngPixmap::PngPixmap(const QPixmap pixmap, const int page,
                      const float resolution)
-    : data(nullptr), resolution(resolution), page(page)
+    : data(nullptr),
+      resolution(resolution),
+      page(page),
+      codec(preferences()->cache_codec)
 {
   // Check if the given pixmap is nontrivial
   if (pixmap.isNull() || pixmap.size().isEmpty() || pixmap.isDetached()) return;
 
+  QElapsedTimer timer;
+  timer.start();
+  if (codec != CacheCodec::PNG) {
+    encode(pixmap.toImage());
+    compress_time = timer.elapsed();
+    return;
+  }
+
   // Save the pixmap as PNG image.
   // First create a writable QByteArray and a QBuffer to write to it.
   QByteArray* bytes = new QByteArray();
@@ -26,6 +46,7 @@ PngPixmap::PngPixmap(const QPixmap pixmap, const int page,
   if (success) {
     // Keep the result in data.
     data = bytes;
+    compress_time = timer.elapsed();
   } else {
     // saving failed, delete result.
     delete bytes;
@@ -33,8 +54,150 @@ PngPixmap::PngPixmap(const QPixmap pixmap, const int page,
   }
 }
 
+PngPixmap::PngPixmap(const QImage& image, const int page,
+                     const float resolution, const CacheCodec codec)
+    : data(nullptr), resolution(resolution), page(page), codec(codec)
+{
+  if (image.isNull() || image.size().isEmpty()) return;
+  QElapsedTimer timer;
+  timer.start();
+  encode(image);
+  compress_time = timer.elapsed();
+}
+
+void PngPixmap::encode(const QImage& image)
+{
+  switch (codec) {
+    case CacheCodec::Fast: {
+      uLongf length = compressBound(image.sizeInBytes());
+      QByteArray* bytes = new QByteArray(length, Qt::Uninitialized);
+      if (compress2(reinterpret_cast<Bytef*>(bytes->data()), &length,
+                    image.constBits(), image.sizeInBytes(),
+                    Z_BEST_SPEED) == Z_OK) {
+        bytes->truncate(length);
+        data = bytes;
+      } else {
+        delete bytes;
+        qWarning() << "Compressing image with zlib failed";
+      }
+      break;
+    }
+    case CacheCodec::Uncompressed:
+      data = new QByteArray(reinterpret_cast<const char*>(image.constBits()),
+                            image.sizeInBytes());
+      break;
+    default: {
+      codec = CacheCodec::PNG;
+      QByteArray* bytes = new QByteArray();
+      QBuffer buffer(bytes);
+      if (buffer.open(QIODevice::WriteOnly) && image.save(&buffer, "PNG"))
+        data = bytes;
+      else {
+        delete bytes;
+        qWarning() << "Compressing image to PNG failed";
+      }
+      return;
+    }
+  }
+  // Raw pixel data requires the geometry of the image for decoding.
+  image_size = image.size();
+  bytes_per_line = image.bytesPerLine();
+  format = image.format();
+}
+
+const QImage PngPixmap::image() const
+{
+  if (data == nullptr || data->isEmpty()) {
+    qWarning() << "Tried to decompress empty image";
+    return QImage();
+  }
+  if (codec == CacheCodec::PNG) {
+    QImage image;
+    if (!image.loadFromData(*data, "PNG"))
+      qWarning() << "Loading image from PNG failed";
+    return image;
+  }
+  QImage image(image_size, format);
+  const qsizetype line_length =
+      (qsizetype(image.width()) * image.depth() + 7) / 8;
+  if (image.isNull() || bytes_per_line < line_length) {
+    qWarning() << "Invalid geometry of cached image";
+    return QImage();
+  }
+  // The stored lines may be aligned differently than the lines of image if
+  // the source image wrapped external memory. In this case the data is
+  // decoded to a buffer and copied line by line.
+  const bool aligned = image.bytesPerLine() == bytes_per_line;
+  const qsizetype raw_size = qsizetype(bytes_per_line) * image.height();
+  QByteArray buffer;
+  if (!aligned) buffer = QByteArray(raw_size, Qt::Uninitialized);
+  uchar* target =
+      aligned ? image.bits() : reinterpret_cast<uchar*>(buffer.data());
+  if (codec == CacheCodec::Fast) {
+    uLongf length = raw_size;
+    if (uncompress(target, &length,
+                   reinterpret_cast<const Bytef*>(data->constData()),
+                   data->size()) != Z_OK ||
+        length != static_cast<uLongf>(raw_size)) {
+      qWarning() << "Decompressing image with zlib failed";
+      return QImage();
+    }
+  } else {
+    if (data->size() != raw_size) {
+      qWarning() << "Invalid size of cached image";
+      return QImage();
+    }
+    std::memcpy(target, data->constData(), raw_size);
+  }
+  if (!aligned)
+    for (int y = 0; y < image.height(); ++y)
+      std::memcpy(image.scanLine(y), target + qsizetype(y) * bytes_per_line,
+                  line_length);
+  return image;
+}
+
+/// Identifier of the format written by PngPixmap::write.
+static constexpr quint32 pngpixmap_magic = 0x42504331;  // "BPC1"
+
+bool PngPixmap::write(QIODevice* device) const
+{
+  if (data == nullptr || device == nullptr) return false;
+  QDataStream stream(device);
+  stream << pngpixmap_magic << static_cast<qint32>(codec) << image_size
+         << static_cast<qint32>(bytes_per_line) << static_cast<qint32>(format)
+         << *data;
+  return stream.status() == QDataStream::Ok;
+}
+
+PngPixmap* PngPixmap::read(QIODevice* device, const int page,
+                           const float resolution)
+{
+  if (device == nullptr) return nullptr;
+  QDataStream stream(device);
+  quint32 magic;
+  qint32 codec, bytes_per_line, format;
+  QSize image_size;
+  QByteArray* bytes = new QByteArray();
+  stream >> magic >> codec >> image_size >> bytes_per_line >> format >> *bytes;
+  if (stream.status() != QDataStream::Ok || magic != pngpixmap_magic ||
+      bytes->isEmpty() ||
+      !get_string_to_cache_codec().values().contains(
+          static_cast<CacheCodec>(codec))) {
+    delete bytes;
+    return nullptr;
+  }
+  PngPixmap* pixmap = new PngPixmap(page, resolution);
+  pixmap->data = bytes;
+  pixmap->codec = static_cast<CacheCodec>(codec);
+  pixmap->image_size = image_size;
+  pixmap->bytes_per_line = bytes_per_line;
+  pixmap->format = static_cast<QImage::Format>(format);
+  return pixmap;
+}
+
 const QPixmap PngPixmap::pixmap() const
 {
+  if (codec != CacheCodec::PNG) return QPixmap::fromImage(image());
   QPixmap pixmap;
   if (data == nullptr || data->isEmpty() || !pixmap.loadFromData(*data, "PNG"))
     qWarning() << "Loading image from PNG failed";
@@ -5,17 +5,25 @@
 #define PNGPIXMAP_H
 
 #include <QByteArray>
+#include <QImage>
+#include <QSize>
 
 #include "src/config.h"
+#include "src/enumerates.h"
 
+class QIODevice;
 class QPixmap;
 
 /**
- * @brief PNG-compressed QPixmap image.
+ * @brief Compressed QPixmap image.
+ *
+ * The name is historical: The image is compressed with one of the codecs
+ * defined in CacheCodec. By default this is PNG. For the other codecs the
+ * raw pixel data of a QImage is stored together with the image geometry.
  */
 class PngPixmap
 {
-  /// PNG-compressed image.
+  /// Compressed image.
   const QByteArray* data;
 
   /// Resolution with which the image was or should be rendered
@@ -25,6 +33,28 @@ class PngPixmap
   /// Page number
   const int page;
 
+  /// Codec used to compress data.
+  CacheCodec codec = CacheCodec::PNG;
+
+  /// Size of the image in pixels (only used for raw pixel data).
+  QSize image_size;
+
+  /// Bytes per line of the source image (only used for raw pixel data).
+  /// This may differ from the alignment used by QImage.
+  int bytes_per_line = 0;
+
+  /// Pixel format of the image (only used for raw pixel data).
+  QImage::Format format = QImage::Format_Invalid;
+
+  /// Time in milliseconds which was needed to render (or load) the image.
+  float render_time = 0.f;
+
+  /// Time in milliseconds which was needed to compress the image.
+  float compress_time = 0.f;
+
+  /// Compress image with codec and write the result to data.
+  void encode(const QImage& image);
+
  public:
   /// Constructor: initialize page and resolution; data=nullptr.
   PngPixmap(const int page, const float resolution) noexcept
@@ -32,17 +62,37 @@ class PngPixmap
   {
   }
 
-  /// Constructor: compresses pixmap to PNG. data is null if compression
-  /// fails.
+  /// Constructor: compresses pixmap using the codec defined in preferences().
+  /// data is null if compression fails.
   PngPixmap(const QPixmap pixmap, const int page, const float resolution);
 
-  /// Constructor: takes ownership of data.
+  /// Constructor: compresses image using the given codec. data is null if
+  /// compression fails.
+  PngPixmap(const QImage& image, const int page, const float resolution,
+            const CacheCodec codec);
+
+  /// Constructor: takes ownership of PNG-compressed data.
   PngPixmap(const QByteArray* data, const int page = 0,
             const float resolution = -1.) noexcept
       : data(data), resolution(resolution), page(page)
   {
   }
 
+  /// Constructor: copy properties of other, but take ownership of new_data
+  /// which must contain the same content as the data of other.
+  PngPixmap(const PngPixmap &other, const QByteArray *new_data) noexcept
+      : data(new_data),
+        resolution(other.resolution),
+        page(other.page),
+        codec(other.codec),
+        image_size(other.image_size),
+        bytes_per_line(other.bytes_per_line),
+        format(other.format),
+        render_time(other.render_time),
+        compress_time(other.compress_time)
+  {
+  }
+
   /// Destructor: deletes data.
   ~PngPixmap() noexcept { delete data; }
 
@@ -50,6 +100,9 @@ class PngPixmap
   /// The caller takes ownership of the returned QPixmap.
   const QPixmap pixmap() const;
 
+  /// Decompress the image and return it as QImage.
+  const QImage image() const;
+
   /// Size of data in bytes.
   int size() const noexcept { return data->size(); }
 
@@ -59,9 +112,33 @@ class PngPixmap
   /// Page number.
   int getPage() const noexcept { return page; }
 
+  /// Codec used to compress the image.
+  CacheCodec getCodec() const noexcept { return codec; }
+
+  /// Time in milliseconds needed to render (or load) the image.
+  float getRenderTime() const noexcept { return render_time; }
+
+  /// Set time in milliseconds needed to render (or load) the image.
+  void setRenderTime(const float time) noexcept { render_time = time; }
+
+  /// Time in milliseconds needed to compress the image.
+  float getCompressTime() const noexcept { return compress_time; }
+
   /// Check whether data == nullptr
   bool isNull() const noexcept { return data == nullptr; }
 
+  /// Compressed data. Must not be used after this is deleted.
+  const QByteArray &getData() const noexcept { return *data; }
+
+  /// Write codec, geometry and compressed data to device.
+  /// Return true if successful.
+  bool write(QIODevice* device) const;
+
+  /// Read image written by write() from device. Return nullptr if reading
+  /// fails. The caller takes ownership of the returned object.
+  static PngPixmap* read(QIODevice* device, const int page,
+                         const float resolution);
+
   /// Return data and set data = nullptr
   const QByteArray* takeData()
   {
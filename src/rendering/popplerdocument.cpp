@@ -1,7 +1,6 @@
 // SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
 // SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
 
-#include <QBuffer>
 #include <QByteArray>
 #include <QFileInfo>
 #include <QImage>
@@ -9,6 +8,7 @@
 #include <QLineEdit>
 #include <QPixmap>
 #include <QPointF>
+#include <QRect>
 #include <QRectF>
 #include <QSizeF>
 #include <QUrl>
@@ -128,7 +128,14 @@ bool PopplerDocument::loadDocument()
 
   // Update document and delete old document.
   if (newdoc != nullptr) doc.swap(newdoc);
-  flexible_page_sizes = -1;
+
+  // Page sizes are needed very often. Determine them once.
+  QVector<QSizeF> sizes(doc->numPages());
+  for (int page = 0; page < sizes.length(); ++page) {
+    const std::unique_ptr<Poppler::Page> docpage(doc->page(page));
+    if (docpage) sizes[page] = docpage->pageSizeF();
+  }
+  setPageTable(std::move(sizes));
 
   return true;
 }
@@ -155,6 +162,27 @@ const QPixmap PopplerDocument::getPixmap(const int page, const qreal resolution,
   }
 }
 
+const QPixmap PopplerDocument::getTile(const int page, const qreal resolution,
+                                       const PagePart page_part,
+                                       const QRect &tile) const
+{
+  const std::unique_ptr<Poppler::Page> docpage(doc->page(page));
+  if (!docpage || resolution <= 0. || tile.isEmpty() ||
+      qreal(tile.width()) * tile.height() > preferences()->max_image_size) {
+    qWarning() << "Tried to render invalid page or invalid tile" << page;
+    return QPixmap();
+  }
+  // Size of the image of the page part.
+  const QSizeF size = resolution * pageSize(page);
+  const int width = page_part == FullPage ? size.width() : size.width() / 2;
+  QRect rect = tile & QRect(0, 0, width, int(size.height()));
+  if (rect.isEmpty()) return QPixmap();
+  if (page_part == RightHalf) rect.translate((int(size.width()) + 1) / 2, 0);
+  return QPixmap::fromImage(docpage->renderToImage(
+      72. * resolution, 72. * resolution, rect.x(), rect.y(), rect.width(),
+      rect.height()));
+}
+
 const PngPixmap *PopplerDocument::getPng(const int page, const qreal resolution,
                                          const PagePart page_part) const
 {
@@ -179,14 +207,14 @@ const PngPixmap *PopplerDocument::getPng(const int page, const qreal resolution,
     default:
       break;
   }
-  QByteArray *const bytes = new QByteArray();
-  QBuffer buffer(bytes);
-  if (!buffer.open(QIODevice::WriteOnly) || !image.save(&buffer, "PNG")) {
-    qWarning() << "Saving page as PNG image failed";
-    delete bytes;
+  const PngPixmap *png =
+      new PngPixmap(image, page, resolution, preferences()->cache_codec);
+  if (png->isNull()) {
+    qWarning() << "Compressing page image failed";
+    delete png;
     return nullptr;
   }
-  return new PngPixmap(bytes, page, resolution);
+  return png;
 }
 
 void PopplerDocument::loadPageLabels()
@@ -391,6 +419,30 @@ const PdfLink *PopplerDocument::linkAt(const int page,
   return nullptr;
 }
 
+QList<int> PopplerDocument::linkTargets(const int page) const
+{
+  const std::unique_ptr<Poppler::Page> docpage(doc->page(page));
+  if (!docpage) return {};
+  QList<int> targets;
+  const auto links = docpage->links();
+  for (auto it = links.cbegin(); it != links.cend(); ++it) {
+    if ((*it)->linkType() != Poppler::Link::Goto) continue;
+    const Poppler::LinkGoto *gotolink =
+#if (QT_VERSION_MAJOR >= 6)
+        static_cast<Poppler::LinkGoto *>(it->get());
+#else
+        static_cast<Poppler::LinkGoto *>(*it);
+#endif
+    const int target = gotolink->destination().pageNumber() - 1;
+    if (!gotolink->isExternal() && target >= 0 && !targets.contains(target))
+      targets.append(target);
+  }
+#if (QT_VERSION_MAJOR < 6)
+  qDeleteAll(links);
+#endif
+  return targets;
+}
+
 QList<std::shared_ptr<MediaAnnotation>> PopplerDocument::annotations(
     const int page)
 {
@@ -598,21 +650,6 @@ const SlideTransition PopplerDocument::transition(const int page) const
   return trans;
 }
 
-bool PopplerDocument::flexiblePageSizes() noexcept
-{
-  if (flexible_page_sizes >= 0 || doc == nullptr) return flexible_page_sizes;
-  const QSizeF ref_size = doc->page(0)->pageSizeF();
-  for (int page = 1; page < doc->numPages(); page++) {
-    const std::unique_ptr<Poppler::Page> docpage(doc->page(page));
-    if (docpage && docpage->pageSizeF() != ref_size) {
-      flexible_page_sizes = 1;
-      return 1;
-    }
-  }
-  flexible_page_sizes = 0;
-  return 0;
-}
-
 void PopplerDocument::loadOutline()
 {
   outline.clear();
@@ -672,3 +709,21 @@ std::pair<int, QList<QRectF>> PopplerDocument::searchAll(const QString &needle,
     }
   return {-1, {}};
 }
+
+bool PopplerDocument::pageText(const int page, PdfPageText &target) const
+{
+  if (!doc || page < 0 || page >= doc->numPages()) return false;
+  const std::unique_ptr<Poppler::Page> docpage(doc->page(page));
+  if (!docpage) return false;
+  const auto words = docpage->textList();
+  for (const auto &word : words) {
+    const QString text = word->text();
+    for (int i = 0; i < text.length(); ++i)
+      target.append(text[i], word->charBoundingBox(i));
+    target.append(' ', QRectF());
+  }
+#if (QT_VERSION_MAJOR < 6)
+  qDeleteAll(words);
+#endif
+  return true;
+}
@@ -7,6 +7,7 @@
 #include <QCoreApplication>
 #include <QList>
 #include <QMap>
+#include <QRect>
 #include <QString>
 #include <QtConfig>
 #include <memory>
@@ -69,17 +70,16 @@ class PopplerDocument : public PdfDocument
   const PngPixmap *getPng(const int page, const qreal resolution,
                           const PagePart page_part) const;
 
+  /// Render part tile of page to QPixmap. tile is given in pixels relative
+  /// to the top left corner of the page part.
+  /// @see AbstractRenderer::renderTile()
+  const QPixmap getTile(const int page, const qreal resolution,
+                        const PagePart page_part, const QRect &tile) const;
+
   /// Load or reload the file. Return true if the file was updated and false
   /// otherwise.
   bool loadDocument() override final;
 
-  /// Size of page in points (inch/72). Empty if page is invalid.
-  const QSizeF pageSize(const int page) const override
-  {
-    const std::unique_ptr<Poppler::Page> docpage(doc->page(page));
-    return docpage ? docpage->pageSizeF() : QSizeF();
-  }
-
   /// Number of pages (0 if doc is null).
   int numberOfPages() const override { return doc ? doc->numPages() : 0; }
 
@@ -99,6 +99,12 @@ class PopplerDocument : public PdfDocument
                                           int start_page = 0,
                                           bool forward = true) const override;
 
+  /// Text extraction is supported.
+  bool hasPageText() const noexcept override { return true; }
+
+  /// Extract text of page from the text boxes of all words.
+  bool pageText(const int page, PdfPageText &target) const override;
+
   /// Page label of given page index. (Empty string if page is invalid.)
   const QString pageLabel(const int page) const override
   {
@@ -112,6 +118,9 @@ class PopplerDocument : public PdfDocument
   /// Link at given position (in point = inch/72).
   const PdfLink *linkAt(const int page, const QPointF &position) const override;
 
+  /// Target pages of all internal navigation links on given page.
+  QList<int> linkTargets(const int page) const override;
+
   /// List all video annotations on given page.
   virtual QList<std::shared_ptr<MediaAnnotation>> annotations(
       const int page) override;
@@ -119,9 +128,6 @@ class PopplerDocument : public PdfDocument
   /// Slide transition when reaching the given page.
   const SlideTransition transition(const int page) const override;
 
-  /// Return true if not all pages in the PDF have the same size.
-  virtual bool flexiblePageSizes() noexcept override;
-
   /// Duration of given page in secons. Default value is -1 is interpreted as
   /// infinity.
   qreal duration(const int page) const noexcept override
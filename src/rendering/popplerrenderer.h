@@ -55,6 +55,16 @@ class PopplerRenderer : public AbstractRenderer
     return doc ? doc->getPng(page, resolution, page_part) : nullptr;
   }
 
+  /// Render part of the page to a QPixmap.
+  const QPixmap renderTile(const int page, const qreal resolution,
+                           const QRect &tile) const override
+  {
+    return doc ? doc->getTile(page, resolution, page_part, tile) : QPixmap();
+  }
+
+  /// Poppler can render parts of a page.
+  bool supportsTiles() const noexcept override { return true; }
+
   /// Check whether doc is valid.
   bool isValid() const override { return doc && doc->isValid(); }
 };
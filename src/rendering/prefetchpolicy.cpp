@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/rendering/prefetchpolicy.h"
+
+#include <cstdlib>
+
+#include "src/log.h"
+#include "src/rendering/pdfdocument.h"
+
+PrefetchPolicy *PrefetchPolicy::create(
+    const PrefetchMode mode, const std::shared_ptr<const PdfDocument> &doc)
+{
+  switch (mode) {
+    case PrefetchMode::Navigation:
+      return new NavigationPrefetchPolicy(doc);
+    default:
+      return new PrefetchPolicy(doc);
+  }
+}
+
+int NavigationPrefetchPolicy::slidePage(const int shift) const
+{
+  int page;
+  if (slide_order.isEmpty() || current_slide < 0)
+    page = current_page + shift;
+  else
+    page = slide_order.value(current_slide + shift, -1);
+  return page < document->numberOfPages() ? page : -1;
+}
+
+void NavigationPrefetchPolicy::pageChanged(const int slide, const int page)
+{
+  if (page == current_page) return;
+  // Only single steps define the direction. Jumps (e.g. by links or the
+  // table of contents) keep the previous direction.
+  const int step = (slide >= 0 && current_slide >= 0) ? slide - current_slide
+                                                      : page - current_page;
+  if (current_page >= 0 && step != 0 && std::abs(step) <= 2)
+    last_direction = step > 0 ? 1 : -1;
+  current_slide = slide >= 0 ? slide : -1;
+  current_page = page;
+  links = document->linkTargets(page);
+  debug_verbose(DebugCache, "prefetch: page" << page << "direction"
+                                             << last_direction << "links"
+                                             << links);
+}
+
+QList<int> NavigationPrefetchPolicy::predict(const int count) const
+{
+  if (current_page < 0 || count <= 0) return {};
+  const int num_pages = document->numberOfPages();
+  QList<int> pages;
+  const auto add = [&](const int page) {
+    if (page >= 0 && page < num_pages && page != current_page &&
+        !pages.contains(page))
+      pages.append(page);
+  };
+  // Neighbouring slides, starting in the direction of navigation.
+  add(slidePage(last_direction));
+  add(slidePage(-last_direction));
+  // Navigation skipping overlays.
+  if (!document->overlayIndices().isEmpty()) {
+    for (const PageShift shift : {
+             PageShift{last_direction, ShiftOverlays::FirstOverlay},
+             PageShift{-last_direction, ShiftOverlays::FirstOverlay},
+             PageShift{0, ShiftOverlays::FirstOverlay},
+             PageShift{0, ShiftOverlays::LastOverlay},
+         })
+      add(document->overlaysShifted(current_page, shift));
+  }
+  // Link targets.
+  for (const int target : links) add(target);
+  // Further slides in the direction of navigation.
+  for (int shift = 2; pages.length() < count; ++shift) {
+    const int page = slidePage(shift * last_direction);
+    if (page < 0) break;
+    add(page);
+  }
+  while (pages.length() > count) pages.removeLast();
+  return pages;
+}
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef PREFETCHPOLICY_H
+#define PREFETCHPOLICY_H
+
+#include <QList>
+#include <memory>
+
+#include "src/config.h"
+#include "src/enumerates.h"
+
+class PdfDocument;
+
+/**
+ * @brief Strategy for choosing pages which are rendered to cache.
+ *
+ * PixCache renders pages in a simply connected region around the current
+ * page. A prefetch policy additionally predicts pages which will probably
+ * be shown next. These pages are rendered before the region is extended and
+ * are not removed from the cache while they are predicted.
+ *
+ * This base class implements the linear policy: it predicts no pages and
+ * assumes that navigation goes forward.
+ *
+ * Objects of this class are only used in the thread of their PixCache.
+ */
+class PrefetchPolicy
+{
+ protected:
+  /// PDF document.
+  std::shared_ptr<const PdfDocument> document;
+
+  /// Page index for each slide (see Master::pageIdx()). Empty if slides
+  /// and pages are identical.
+  QList<int> slide_order;
+
+ public:
+  /// Constructor
+  explicit PrefetchPolicy(const std::shared_ptr<const PdfDocument> &doc)
+      : document(doc)
+  {
+  }
+
+  virtual ~PrefetchPolicy() = default;
+
+  /// Create a policy for the given mode.
+  static PrefetchPolicy *create(const PrefetchMode mode,
+                                const std::shared_ptr<const PdfDocument> &doc);
+
+  /// Set page index for each slide.
+  void setSlideOrder(const QList<int> &order) { slide_order = order; }
+
+  /// Notify the policy that slide with given page is now shown.
+  virtual void pageChanged(const int slide, const int page) {}
+
+  /// Pages which will probably be shown after the current page, most likely
+  /// first. The list contains at most count valid page numbers, excluding
+  /// the current page.
+  virtual QList<int> predict(const int count) const { return {}; }
+
+  /// Direction of recent navigation: 1 for forward, -1 for backward.
+  virtual int direction() const noexcept { return 1; }
+};
+
+/**
+ * @brief Prefetch policy based on navigation signals.
+ *
+ * Predicts the next pages in the following order:
+ * 1. next slide in the direction of the last navigation step,
+ * 2. neighbouring slide in the other direction,
+ * 3. first page of next and previous slide (skipping overlays) and first
+ *    and last overlay of the current slide,
+ * 4. targets of links on the current page,
+ * 5. further slides in the direction of navigation.
+ *
+ * Slides are mapped to pages by the slide order of Master.
+ */
+class NavigationPrefetchPolicy : public PrefetchPolicy
+{
+  /// Slide index of the current page, -1 if unknown.
+  int current_slide = -1;
+
+  /// Current page.
+  int current_page = -1;
+
+  /// Direction of the last navigation step.
+  int last_direction = 1;
+
+  /// Link targets on current_page.
+  QList<int> links;
+
+  /// Page shown after shifting current slide by given number of slides.
+  /// Return -1 if this page does not exist.
+  int slidePage(const int shift) const;
+
+ public:
+  /// Constructor
+  explicit NavigationPrefetchPolicy(
+      const std::shared_ptr<const PdfDocument> &doc)
+      : PrefetchPolicy(doc)
+  {
+  }
+
+  /// Update direction and link targets.
+  void pageChanged(const int slide, const int page) override;
+
+  /// Predict pages shown after the current page.
+  QList<int> predict(const int count) const override;
+
+  /// Direction of the last navigation step.
+  int direction() const noexcept override { return last_direction; }
+};
+
+#endif  // PREFETCHPOLICY_H
@@ -3,7 +3,6 @@
 
 #include "src/rendering/qtdocument.h"
 
-#include <QBuffer>
 #include <QByteArray>
 #include <QFileInfo>
 #include <QImage>
@@ -129,7 +128,12 @@ bool QtDocument::loadDocument()
 
   // Save the modification time.
   lastModified = fileinfo.lastModified();
-  flexible_page_sizes = -1;
+
+  // Page sizes are needed very often. Determine them once.
+  QVector<QSizeF> sizes(doc->pageCount());
+  for (int page = 0; page < sizes.length(); ++page)
+    sizes[page] = doc->PAGESIZE_FUNCTION(page);
+  setPageTable(std::move(sizes));
 
   return true;
 }
@@ -183,29 +187,14 @@ const PngPixmap *QtDocument::getPng(const int page, const qreal resolution,
     default:
       break;
   }
-  QByteArray *const bytes = new QByteArray();
-  QBuffer buffer(bytes);
-  buffer.open(QIODevice::WriteOnly);
-  if (!image.save(&buffer, "PNG")) {
-    qWarning() << "Saving page as PNG image failed";
-    delete bytes;
+  const PngPixmap *png =
+      new PngPixmap(image, page, resolution, preferences()->cache_codec);
+  if (png->isNull()) {
+    qWarning() << "Compressing page image failed";
+    delete png;
     return nullptr;
   }
-  return new PngPixmap(bytes, page, resolution);
-}
-
-bool QtDocument::flexiblePageSizes() noexcept
-{
-  if (flexible_page_sizes >= 0 || !isValid()) return flexible_page_sizes;
-  const QSizeF ref_size = doc->PAGESIZE_FUNCTION(0);
-  for (int page = 1; page < doc->pageCount(); page++) {
-    if (doc->PAGESIZE_FUNCTION(page) != ref_size) {
-      flexible_page_sizes = 1;
-      return 1;
-    }
-  }
-  flexible_page_sizes = 0;
-  return 0;
+  return png;
 }
 
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 5, 0))
@@ -74,12 +74,6 @@ class QtDocument : public PdfDocument
   }
 #endif  // QT_VERSION >= 6.5
 
-  /// Size of page in points (inch/72). Empty if page is invalid.
-  const QSizeF pageSize(const int page) const override
-  {
-    return doc->PAGESIZE_FUNCTION(page);
-  }
-
   /// Number of pages (0 if doc is null).
   int numberOfPages() const override { return doc->pageCount(); }
 
@@ -88,9 +82,6 @@ class QtDocument : public PdfDocument
   {
     return doc->status() == QPdfDocument::Status::Ready;
   }
-
-  /// Return true if not all pages in the PDF have the same size.
-  virtual bool flexiblePageSizes() noexcept override;
 };
 
 #endif  // QTDOCUMENT_H
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/rendering/renderpool.h"
+
+#include <QThread>
+#include <algorithm>
+
+#include "src/log.h"
+#include "src/preferences.h"
+
+RenderPool::RenderPool()
+{
+  int number = preferences()->rendering_threads;
+  if (number <= 0) number = QThread::idealThreadCount();
+  if (number <= 0) number = 1;
+  debug_msg(DebugThreads, "starting render pool with threads:" << number);
+  workers.reserve(number);
+  for (int i = 0; i < number; ++i) {
+    QThread *thread = QThread::create([this]() { work(); });
+    thread->start(QThread::LowPriority);
+    workers.append(thread);
+  }
+}
+
+RenderPool::~RenderPool()
+{
+  mutex.lock();
+  stopping = true;
+  queue.clear();
+  job_queued.wakeAll();
+  mutex.unlock();
+  for (const auto thread : std::as_const(workers)) {
+    thread->wait();
+    delete thread;
+  }
+}
+
+RenderPool &RenderPool::instance()
+{
+  static RenderPool pool;
+  return pool;
+}
+
+void RenderPool::submit(const void *owner, const Priority priority,
+                        std::function<void()> &&work)
+{
+  mutex.lock();
+  // Insert after all jobs with equal or higher priority.
+  auto it = queue.begin();
+  while (it != queue.end() && it->priority <= priority) ++it;
+  queue.insert(it, {priority, owner, std::move(work)});
+  max_queued = std::max(max_queued, static_cast<int>(queue.length()));
+  job_queued.wakeOne();
+  mutex.unlock();
+}
+
+int RenderPool::remove(const void *owner)
+{
+  QMutexLocker locker(&mutex);
+  return removeQueued(owner);
+}
+
+int RenderPool::removeQueued(const void *owner)
+{
+  int removed = 0;
+  for (auto it = queue.begin(); it != queue.end();) {
+    if (it->owner == owner) {
+      it = queue.erase(it);
+      ++removed;
+    } else
+      ++it;
+  }
+  return removed;
+}
+
+void RenderPool::cancel(const void *owner)
+{
+  QMutexLocker locker(&mutex);
+  // A running job of owner may submit new jobs. Hence, queued jobs are
+  // removed again after each finished job.
+  removeQueued(owner);
+  while (running.contains(owner)) {
+    job_finished.wait(&mutex);
+    removeQueued(owner);
+  }
+}
+
+int RenderPool::queueLength()
+{
+  QMutexLocker locker(&mutex);
+  return queue.length();
+}
+
+int RenderPool::maxQueueLength()
+{
+  QMutexLocker locker(&mutex);
+  return max_queued;
+}
+
+void RenderPool::work()
+{
+  mutex.lock();
+  while (true) {
+    while (!stopping && queue.isEmpty()) job_queued.wait(&mutex);
+    if (stopping) break;
+    Job job = queue.takeFirst();
+    running.append(job.owner);
+    mutex.unlock();
+    job.work();
+    mutex.lock();
+    running.removeOne(job.owner);
+    job_finished.wakeAll();
+  }
+  mutex.unlock();
+}
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef RENDERPOOL_H
+#define RENDERPOOL_H
+
+#include <QList>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+#include <functional>
+
+#include "src/config.h"
+
+class QThread;
+
+/**
+ * @brief Global pool of threads for rendering pages in the background.
+ *
+ * All caches and thumbnail widgets submit their rendering jobs to this
+ * pool. The number of threads is given by preferences()->rendering_threads
+ * or derived from the number of CPU cores. Jobs are executed in order of
+ * their priority and, for equal priorities, in the order of submission.
+ * Each idle thread takes the next job from the shared queue.
+ *
+ * Jobs are identified by an owner. Before the owner is deleted, it must
+ * call cancel() to make sure that none of its jobs is queued or running.
+ */
+class RenderPool
+{
+ public:
+  /// Priority of a job, lower values are handled first.
+  enum Priority {
+    VisiblePage = 0,  ///< page which is currently shown
+    NextPage,         ///< page which will probably be shown next
+    Saving,           ///< drawings written to a file
+    Search,           ///< text search requested by the user
+    Prefetch,         ///< other pages in cache
+    Thumbnail,        ///< thumbnails
+    Export,           ///< pages exported to files
+    Indexing,         ///< text index built in the background
+    Hashing,          ///< page hashes used when the document is reloaded
+  };
+
+ private:
+  /// Job in the queue.
+  struct Job {
+    Priority priority;
+    /// Owner of the job, only used for identification.
+    const void *owner;
+    /// Function doing the work.
+    std::function<void()> work;
+  };
+
+  /// Queued jobs, sorted by priority.
+  QList<Job> queue;
+
+  /// Owners of currently running jobs (may contain duplicates).
+  QList<const void *> running;
+
+  /// Worker threads.
+  QVector<QThread *> workers;
+
+  /// Mutex for queue, running and stopping.
+  QMutex mutex;
+
+  /// Wakes up workers when jobs are queued.
+  QWaitCondition job_queued;
+
+  /// Wakes up cancel() when a job has finished.
+  QWaitCondition job_finished;
+
+  /// Set when threads should stop.
+  bool stopping = false;
+
+  /// Largest number of queued jobs so far.
+  int max_queued = 0;
+
+  /// Constructor: start worker threads.
+  RenderPool();
+
+  /// Main loop of worker threads.
+  void work();
+
+  /// Remove all queued jobs of owner. Return the number of removed jobs.
+  /// mutex must be locked.
+  int removeQueued(const void *owner);
+
+ public:
+  /// Destructor: stop worker threads.
+  ~RenderPool();
+
+  /// Get the global render pool. Starts the threads on first call.
+  static RenderPool &instance();
+
+  /// Queue a job with given owner and priority.
+  void submit(const void *owner, const Priority priority,
+              std::function<void()> &&work);
+
+  /// Remove all queued jobs of owner. Return the number of removed jobs.
+  int remove(const void *owner);
+
+  /// Remove all queued jobs of owner and wait until no job of owner
+  /// is running. Jobs submitted by running jobs of owner are removed, too.
+  void cancel(const void *owner);
+
+  /// Number of worker threads.
+  int threadCount() const noexcept { return workers.length(); }
+
+  /// Number of queued jobs.
+  int queueLength();
+
+  /// Largest number of queued jobs so far.
+  int maxQueueLength();
+};
+
+#endif  // RENDERPOOL_H
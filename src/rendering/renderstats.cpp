@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/rendering/renderstats.h"
+
+#include <QJsonArray>
+#include <algorithm>
+
+#include "src/rendering/renderpool.h"
+
+void DurationHistogram::add(const float ms) noexcept
+{
+  const auto bin = std::lower_bound(bounds.cbegin(), bounds.cend(), ms);
+  ++bins[bin - bounds.cbegin()];
+  ++number;
+  sum += ms;
+  maximum = std::max(maximum, ms);
+}
+
+void DurationHistogram::merge(const DurationHistogram &other) noexcept
+{
+  for (size_t i = 0; i < bins.size(); ++i) bins[i] += other.bins[i];
+  number += other.number;
+  sum += other.sum;
+  maximum = std::max(maximum, other.maximum);
+}
+
+QJsonObject DurationHistogram::toJson() const
+{
+  QJsonObject bin_obj;
+  for (size_t i = 0; i < bins.size(); ++i) {
+    if (bins[i] == 0) continue;
+    const QString key =
+        i < bounds.size() ? QString::number(bounds[i]) : QString("inf");
+    bin_obj.insert(key, static_cast<qint64>(bins[i]));
+  }
+  return {
+      {"count", static_cast<qint64>(number)},
+      {"mean", mean()},
+      {"max", maximum},
+      {"bins", bin_obj},
+  };
+}
+
+CacheStats::CacheStats(const QString &name, const QString &renderer)
+    : name(name), renderer(renderer)
+{
+  RenderStats::instance().add(this);
+}
+
+CacheStats::~CacheStats() { RenderStats::instance().remove(this); }
+
+void CacheStats::addLookup(const Lookup type) noexcept
+{
+  QMutexLocker locker(&mutex);
+  switch (type) {
+    case DecodedHit:
+      ++decoded_hits;
+      break;
+    case Hit:
+      ++hits;
+      break;
+    case DiskHit:
+      ++disk_hits;
+      break;
+    case Miss:
+      ++misses;
+      break;
+  }
+}
+
+void CacheStats::addEviction() noexcept
+{
+  QMutexLocker locker(&mutex);
+  ++evictions;
+}
+
+void CacheStats::addRender(const int page, const float ms) noexcept
+{
+  QMutexLocker locker(&mutex);
+  render.add(ms);
+  page_render[page] = ms;
+}
+
+void CacheStats::addCompression(const float ms) noexcept
+{
+  QMutexLocker locker(&mutex);
+  compress.add(ms);
+}
+
+void CacheStats::addDecompression(const float ms) noexcept
+{
+  QMutexLocker locker(&mutex);
+  decompress.add(ms);
+}
+
+void CacheStats::setMemory(const qint64 used, const qint64 decoded) noexcept
+{
+  QMutexLocker locker(&mutex);
+  bytes = used;
+  decoded_bytes = decoded;
+}
+
+DurationHistogram CacheStats::renderHistogram() const
+{
+  QMutexLocker locker(&mutex);
+  return render;
+}
+
+QJsonObject CacheStats::toJson() const
+{
+  QMutexLocker locker(&mutex);
+  const quint64 requests = decoded_hits + hits + disk_hits + misses;
+  QJsonObject pages;
+  for (auto it = page_render.cbegin(); it != page_render.cend(); ++it)
+    pages.insert(QString::number(it.key()), it.value());
+  return {
+      {"name", name},
+      {"renderer", renderer},
+      {"decoded hits", static_cast<qint64>(decoded_hits)},
+      {"hits", static_cast<qint64>(hits)},
+      {"disk hits", static_cast<qint64>(disk_hits)},
+      {"misses", static_cast<qint64>(misses)},
+      {"hit rate",
+       requests ? double(decoded_hits + hits + disk_hits) / requests : 0.},
+      {"evictions", static_cast<qint64>(evictions)},
+      {"bytes", bytes},
+      {"decoded bytes", decoded_bytes},
+      {"render ms", render.toJson()},
+      {"compress ms", compress.toJson()},
+      {"decompress ms", decompress.toJson()},
+      {"page render ms", pages},
+  };
+}
+
+RenderStats &RenderStats::instance()
+{
+  static RenderStats stats;
+  return stats;
+}
+
+void RenderStats::add(const CacheStats *stats)
+{
+  QMutexLocker locker(&mutex);
+  caches.append(stats);
+}
+
+void RenderStats::remove(const CacheStats *stats)
+{
+  QMutexLocker locker(&mutex);
+  caches.removeAll(stats);
+}
+
+void RenderStats::navigationStarted() noexcept
+{
+  QMutexLocker locker(&mutex);
+  navigation_timer.start();
+}
+
+void RenderStats::pageShown() noexcept
+{
+  QMutexLocker locker(&mutex);
+  if (!navigation_timer.isValid()) return;
+  navigation.add(navigation_timer.elapsed());
+  navigation_timer.invalidate();
+}
+
+QJsonObject RenderStats::toJson() const
+{
+  RenderPool &pool = RenderPool::instance();
+  QMutexLocker locker(&mutex);
+  QJsonArray cache_array;
+  QMap<QString, DurationHistogram> renderers;
+  for (const auto stats : caches) {
+    cache_array.append(stats->toJson());
+    renderers[stats->getRenderer()].merge(stats->renderHistogram());
+  }
+  QJsonObject renderer_obj;
+  for (auto it = renderers.cbegin(); it != renderers.cend(); ++it)
+    renderer_obj.insert(it.key(), it->toJson());
+  return {
+      {"caches", cache_array},
+      {"renderers", renderer_obj},
+      {"render pool",
+       QJsonObject{
+           {"threads", pool.threadCount()},
+           {"queued", pool.queueLength()},
+           {"max queued", pool.maxQueueLength()},
+       }},
+      {"navigation to page ms", navigation.toJson()},
+  };
+}
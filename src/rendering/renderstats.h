@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <array>
+
+#include "src/config.h"
+
+/**
+ * @brief Histogram of durations in milliseconds with logarithmic bins.
+ *
+ * Not thread save.
+ */
+class DurationHistogram
+{
+  /// Upper bounds of the bins in ms. The last bin has no upper bound.
+  static constexpr std::array<float, 12> bounds{
+      1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
+  /// Number of entries in each bin.
+  std::array<quint64, bounds.size() + 1> bins{};
+
+  /// Total number of entries.
+  quint64 number = 0;
+
+  /// Sum of all entries in ms.
+  double sum = 0.;
+
+  /// Largest entry in ms.
+  float maximum = 0.f;
+
+ public:
+  /// Add duration in ms.
+  void add(const float ms) noexcept;
+
+  /// Add all entries of other.
+  void merge(const DurationHistogram &other) noexcept;
+
+  /// Number of entries.
+  quint64 count() const noexcept { return number; }
+
+  /// Average duration in ms.
+  double mean() const noexcept { return number ? sum / number : 0.; }
+
+  /// Count, mean, maximum and bins (keyed by upper bound) as JSON object.
+  QJsonObject toJson() const;
+};
+
+/**
+ * @brief Counters and histograms of one PixCache.
+ *
+ * The object registers itself in RenderStats::instance() when it is
+ * constructed and unregisters when it is destroyed. All methods are
+ * thread save.
+ */
+class CacheStats
+{
+  /// Mutex for all members.
+  mutable QMutex mutex;
+
+  /// Name identifying the cache.
+  const QString name;
+
+  /// Name of the renderer.
+  const QString renderer;
+
+  /// Requests answered from decoded pages.
+  quint64 decoded_hits = 0;
+
+  /// Requests answered from compressed pages.
+  quint64 hits = 0;
+
+  /// Requests answered from disk cache.
+  quint64 disk_hits = 0;
+
+  /// Requests for which the page had to be rendered.
+  quint64 misses = 0;
+
+  /// Pages removed from cache to free memory.
+  quint64 evictions = 0;
+
+  /// Memory used by compressed pages in bytes.
+  qint64 bytes = 0;
+
+  /// Memory used by decoded pages in bytes.
+  qint64 decoded_bytes = 0;
+
+  /// Time needed to render (or load in the background) pages.
+  DurationHistogram render;
+
+  /// Time needed to compress pages.
+  DurationHistogram compress;
+
+  /// Time needed to decompress pages.
+  DurationHistogram decompress;
+
+  /// Last render time in ms for each page.
+  QMap<int, float> page_render;
+
+ public:
+  /// Type of a request for a page.
+  enum Lookup {
+    DecodedHit,
+    Hit,
+    DiskHit,
+    Miss,
+  };
+
+  /// Constructor: register in RenderStats.
+  CacheStats(const QString &name, const QString &renderer);
+
+  /// Destructor: unregister from RenderStats.
+  ~CacheStats();
+
+  /// Count a request for a page.
+  void addLookup(const Lookup type) noexcept;
+
+  /// Count a page removed from cache.
+  void addEviction() noexcept;
+
+  /// Add render time of page in ms.
+  void addRender(const int page, const float ms) noexcept;
+
+  /// Add time needed to compress a page in ms.
+  void addCompression(const float ms) noexcept;
+
+  /// Add time needed to decompress a page in ms.
+  void addDecompression(const float ms) noexcept;
+
+  /// Set memory used by compressed and decoded pages.
+  void setMemory(const qint64 used, const qint64 decoded) noexcept;
+
+  /// Name of the renderer.
+  const QString &getRenderer() const noexcept { return renderer; }
+
+  /// Copy of the render time histogram.
+  DurationHistogram renderHistogram() const;
+
+  /// All counters and histograms as JSON object.
+  QJsonObject toJson() const;
+};
+
+/**
+ * @brief Global collection of cache and rendering statistics.
+ *
+ * Collects the statistics of all PixCache objects, the queue of the
+ * RenderPool and the time from navigation to showing the new page.
+ * Counters are always collected, independent of debugging options.
+ * All methods are thread save.
+ */
+class RenderStats
+{
+  /// Mutex for all members.
+  mutable QMutex mutex;
+
+  /// Registered caches.
+  QList<const CacheStats *> caches;
+
+  /// Time from navigation to showing the new page.
+  DurationHistogram navigation;
+
+  /// Started when navigating, valid until the new page is shown.
+  QElapsedTimer navigation_timer;
+
+  RenderStats() = default;
+
+ public:
+  /// Get the global object.
+  static RenderStats &instance();
+
+  /// Register cache statistics.
+  void add(const CacheStats *stats);
+
+  /// Unregister cache statistics.
+  void remove(const CacheStats *stats);
+
+  /// Navigation event: start measuring the time until the page is shown.
+  void navigationStarted() noexcept;
+
+  /// A page has been shown after navigation. Only the first call after
+  /// navigationStarted() is considered.
+  void pageShown() noexcept;
+
+  /// All statistics as JSON object.
+  QJsonObject toJson() const;
+};
+
+#endif  // RENDERSTATS_H
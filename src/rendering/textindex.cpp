@@ -0,0 +1,287 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#include "src/rendering/textindex.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+#include "src/log.h"
+#include "src/rendering/diskcache.h"
+#include "src/rendering/renderpool.h"
+
+/// Identifier of the format of cached text indexes.
+static constexpr quint32 textindex_magic = 0x42505432;  // "BPT2"
+
+TextIndex::TextIndex(const std::shared_ptr<const PdfDocument> &doc,
+                     QObject *parent)
+    : QObject(parent),
+      document(doc),
+      number_of_pages(doc->numberOfPages())
+{
+  pages.resize(number_of_pages);
+}
+
+TextIndex::~TextIndex()
+{
+  stopping = true;
+  ++search_id;
+  RenderPool::instance().cancel(this);
+}
+
+QString TextIndex::normalize(const QString &text)
+{
+  QString result(text);
+  for (QChar &c : result) {
+    if (c.isSurrogate()) continue;
+    // The canonical decomposition starts with the base character.
+    const QString decomposed = c.decomposition();
+    if (!decomposed.isEmpty() &&
+        c.decompositionTag() == QChar::Canonical &&
+        !decomposed.front().isSurrogate())
+      c = decomposed.front();
+    c = c.toCaseFolded();
+  }
+  return result;
+}
+
+QString TextIndex::cachePath() const
+{
+  const QByteArray hash = DiskCache::fileHash(document->getPath());
+  if (hash.isEmpty()) return QString();
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/text/" + QString::fromLatin1(hash) + ".bpt";
+}
+
+bool TextIndex::readCache()
+{
+  const QString path = cachePath();
+  if (path.isEmpty()) return false;
+  QFile file(path);
+  if (!file.open(QFile::ReadOnly)) return false;
+  QDataStream stream(&file);
+  quint32 magic;
+  qint32 number;
+  stream >> magic >> number;
+  if (stream.status() != QDataStream::Ok || magic != textindex_magic ||
+      number != number_of_pages)
+    return false;
+  QVector<PageEntry> entries;
+  entries.reserve(number);
+  for (int page = 0; page < number; ++page) {
+    const auto entry = std::make_shared<IndexedPage>();
+    stream >> entry->text >> entry->boxes;
+    if (stream.status() != QDataStream::Ok ||
+        entry->text.length() != entry->boxes.length()) {
+      qWarning() << "Ignoring invalid cached text index:" << path;
+      return false;
+    }
+    entry->normalized = normalize(entry->text);
+    entries.append(entry);
+  }
+  // Mark the file as recently used. This requires an open file.
+  if (!file.setFileTime(QDateTime::currentDateTime(),
+                        QFileDevice::FileModificationTime))
+    debug_msg(DebugCache, "failed to update time of text index" << path);
+  file.close();
+  QMutexLocker locker(&mutex);
+  pages = entries;
+  indexed_pages = number;
+  loaded = true;
+  debug_msg(DebugCache, "loaded text index from disk cache" << path);
+  return true;
+}
+
+void TextIndex::writeCache() const
+{
+  const QString path = cachePath();
+  if (path.isEmpty() || !QDir().mkpath(QFileInfo(path).path())) return;
+  QSaveFile file(path);
+  if (!file.open(QFile::WriteOnly)) return;
+  QDataStream stream(&file);
+  mutex.lock();
+  stream << textindex_magic << static_cast<qint32>(number_of_pages);
+  for (const auto &entry : pages) stream << entry->text << entry->boxes;
+  mutex.unlock();
+  if (stream.status() != QDataStream::Ok || !file.commit()) {
+    qWarning() << "Writing text index to disk cache failed:" << path;
+    return;
+  }
+  debug_msg(DebugCache, "wrote text index to disk cache" << path);
+  // Text indexes count towards the size limit of the disk cache.
+  DiskCache::addSize(QFileInfo(path).size());
+}
+
+bool TextIndex::isComplete() const
+{
+  QMutexLocker locker(&mutex);
+  return indexed_pages == number_of_pages;
+}
+
+TextIndex::PageEntry TextIndex::indexPage(const int page)
+{
+  mutex.lock();
+  PageEntry entry = pages.value(page);
+  mutex.unlock();
+  if (entry) return entry;
+
+  PdfPageText text;
+  if (!document->pageText(page, text))
+    qWarning() << "Could not extract text of page" << page;
+  const auto indexed = std::make_shared<IndexedPage>();
+  indexed->normalized = normalize(text.text);
+  indexed->text = std::move(text.text);
+  indexed->boxes = std::move(text.boxes);
+  debug_verbose(DebugRendering, "indexed text of page" << page);
+
+  mutex.lock();
+  // Another thread might have indexed the same page in the meantime.
+  if (!pages[page]) {
+    pages[page] = indexed;
+    ++indexed_pages;
+  }
+  entry = pages[page];
+  const bool write = indexed_pages == number_of_pages && !loaded;
+  mutex.unlock();
+  if (write && DiskCache::enabled()) writeCache();
+  return entry;
+}
+
+void TextIndex::start()
+{
+  RenderPool::instance().submit(this, RenderPool::Indexing, [this]() {
+    if (stopping || (DiskCache::enabled() && readCache())) return;
+    // Jobs are only submitted from the thread of this object. A queued call
+    // is dropped if this is deleted in the meantime.
+    QMetaObject::invokeMethod(this, &TextIndex::submitPages,
+                              Qt::QueuedConnection);
+  });
+}
+
+void TextIndex::submitPages()
+{
+  if (stopping) return;
+  for (int page = 0; page < number_of_pages; ++page)
+    RenderPool::instance().submit(this, RenderPool::Indexing, [this, page]() {
+      if (!stopping) indexPage(page);
+    });
+}
+
+QList<int> TextIndex::matchPositions(const IndexedPage &entry,
+                                     const QString &needle)
+{
+  QList<int> positions;
+  int index = entry.normalized.indexOf(needle);
+  while (index >= 0) {
+    positions.append(index);
+    index = entry.normalized.indexOf(needle, index + needle.length());
+  }
+  return positions;
+}
+
+QList<QRectF> TextIndex::matchOutline(const IndexedPage &entry,
+                                      const QList<int> &positions,
+                                      const int length)
+{
+  QList<QRectF> results;
+  for (const int position : positions) {
+    // Combine the boxes of all characters in a line.
+    QRectF rect;
+    for (int i = position; i < position + length; ++i) {
+      const QRectF &box = entry.boxes[i];
+      if (box.isEmpty()) continue;
+      if (!rect.isNull() && (box.center().y() < rect.top() ||
+                             box.center().y() > rect.bottom())) {
+        results.append(rect);
+        rect = QRectF();
+      }
+      rect = rect.isNull() ? box : rect.united(box);
+    }
+    if (!rect.isNull()) results.append(rect);
+  }
+  return results;
+}
+
+QString TextIndex::snippet(const IndexedPage &entry, const int position,
+                           const int length)
+{
+  const int start = std::max(0, position - snippet_context);
+  const int end =
+      std::min<int>(entry.text.length(), position + length + snippet_context);
+  QString result = entry.text.mid(start, end - start).trimmed();
+  if (start > 0) result.prepend(QChar(0x2026));
+  if (end < entry.text.length()) result.append(QChar(0x2026));
+  return result;
+}
+
+std::pair<int, QList<QRectF>> TextIndex::find(const QString &needle,
+                                              const int start_page,
+                                              const bool forward,
+                                              const int id)
+{
+  const int step = forward ? 1 : -1;
+  for (int page = start_page; page >= 0 && page < number_of_pages;
+       page += step) {
+    if (stopping || search_id != id) break;
+    const PageEntry entry = indexPage(page);
+    const QList<int> positions = matchPositions(*entry, needle);
+    if (!positions.isEmpty())
+      return {page, matchOutline(*entry, positions, needle.length())};
+  }
+  return {-1, {}};
+}
+
+void TextIndex::search(const QString &needle, int start_page,
+                       const bool forward)
+{
+  const QString normalized = normalize(needle.simplified());
+  const int id = ++search_id;
+  if (normalized.isEmpty() || number_of_pages <= 0) {
+    emit searchFinished(-1, {});
+    return;
+  }
+  start_page = std::clamp(start_page, 0, number_of_pages - 1);
+  if (isComplete()) {
+    const auto [page, results] = find(normalized, start_page, forward, id);
+    emit searchFinished(page, results);
+    return;
+  }
+  debug_msg(DebugRendering, "searching in incomplete text index" << needle);
+  RenderPool::instance().submit(
+      this, RenderPool::Search, [this, normalized, start_page, forward, id]() {
+        const auto [page, results] = find(normalized, start_page, forward, id);
+        // Drop results of outdated searches.
+        if (search_id == id) emit searchFinished(page, results);
+      });
+}
+
+void TextIndex::searchAllPages(const QString &needle)
+{
+  const QString normalized = normalize(needle.simplified());
+  const int id = ++search_all_id;
+  if (normalized.isEmpty()) {
+    emit searchAllFinished(0);
+    return;
+  }
+  RenderPool::instance().submit(
+      this, RenderPool::Search, [this, normalized, id]() {
+        int hits = 0;
+        for (int page = 0; page < number_of_pages; ++page) {
+          if (stopping || search_all_id != id) return;
+          const PageEntry entry = indexPage(page);
+          const QList<int> positions = matchPositions(*entry, normalized);
+          if (positions.isEmpty()) continue;
+          hits += positions.length();
+          emit pageMatches(
+              page, positions.length(),
+              matchOutline(*entry, positions, normalized.length()),
+              snippet(*entry, positions.first(), normalized.length()));
+        }
+        if (search_all_id == id) emit searchAllFinished(hits);
+      });
+}
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2022 Valentin Bruch <software@vbruch.eu>
+// SPDX-License-Identifier: GPL-3.0-or-later OR AGPL-3.0-or-later
+
+#ifndef TEXTINDEX_H
+#define TEXTINDEX_H
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "src/config.h"
+#include "src/rendering/pdfdocument.h"
+
+/**
+ * @brief Full-text index of a PDF document for fast searching.
+ *
+ * The text of each page is extracted once using PdfDocument::pageText() and
+ * kept in memory. Text is normalized by removing diacritics and case
+ * folding each character, such that positions in the normalized text
+ * still correspond to the character bounding boxes.
+ *
+ * Pages are indexed in the background by the RenderPool with low priority.
+ * A search which reaches a page which is not indexed yet indexes this page
+ * itself in a worker thread. Results are reported by the signal
+ * searchFinished(). When the index is complete, searching happens directly
+ * in the calling thread. Searching in all pages always happens in a worker
+ * thread and streams the matches page by page.
+ *
+ * If the disk cache is enabled, complete indexes are stored in the cache
+ * directory (usually ~/.cache/beamerpresenter/text), identified by the hash
+ * of the PDF file.
+ */
+class TextIndex : public QObject
+{
+  Q_OBJECT
+
+  /// Indexed text of a page.
+  struct IndexedPage {
+    /// Text as extracted from the document, used for snippets.
+    QString text;
+    /// Normalized text, used for searching.
+    QString normalized;
+    /// Bounding box of each character in points.
+    QVector<QRectF> boxes;
+  };
+
+  /// Text of a page, shared between index and running searches.
+  using PageEntry = std::shared_ptr<const IndexedPage>;
+
+  /// Number of characters shown before and after a match in snippets.
+  static constexpr int snippet_context = 30;
+
+  /// Document from which the text is extracted.
+  const std::shared_ptr<const PdfDocument> document;
+
+  /// Number of pages in document.
+  const int number_of_pages;
+
+  /// Mutex for pages, indexed_pages and loaded.
+  mutable QMutex mutex;
+
+  /// Text of each page, nullptr for pages which are not indexed yet.
+  QVector<PageEntry> pages;
+
+  /// Number of non-null entries in pages.
+  int indexed_pages = 0;
+
+  /// Index was read from disk (no need to write it again).
+  bool loaded = false;
+
+  /// Identifier of the latest search. Running searches with a different
+  /// identifier are aborted.
+  std::atomic<int> search_id{0};
+
+  /// Identifier of the latest search in all pages.
+  std::atomic<int> search_all_id{0};
+
+  /// Set when the object is being deleted.
+  std::atomic<bool> stopping{false};
+
+  /// Path to the cached index file. Empty if the file cannot be hashed.
+  QString cachePath() const;
+
+  /// Read index from disk cache. Return true on success.
+  bool readCache();
+
+  /// Write complete index to disk cache.
+  void writeCache() const;
+
+  /// Get text of page, extract it if necessary.
+  PageEntry indexPage(const int page);
+
+  /// Submit jobs for indexing all pages to the RenderPool. Called in the
+  /// thread of this object if the index could not be read from disk.
+  void submitPages();
+
+  /// Search needle (normalized) in all pages starting from start_page.
+  /// Return empty results if the search with given id is not the latest
+  /// search anymore.
+  std::pair<int, QList<QRectF>> find(const QString &needle,
+                                     const int start_page, const bool forward,
+                                     const int id);
+
+  /// Positions of all occurrences of needle (normalized) in entry.
+  static QList<int> matchPositions(const IndexedPage &entry,
+                                   const QString &needle);
+
+  /// Outline of matches of given length at positions in entry.
+  static QList<QRectF> matchOutline(const IndexedPage &entry,
+                                    const QList<int> &positions,
+                                    const int length);
+
+  /// Text around the match of given length at position in entry.
+  static QString snippet(const IndexedPage &entry, const int position,
+                         const int length);
+
+ public:
+  /// Constructor: initialize empty index.
+  explicit TextIndex(const std::shared_ptr<const PdfDocument> &doc,
+                     QObject *parent = nullptr);
+
+  /// Destructor: stop all running jobs.
+  ~TextIndex();
+
+  /// Normalize text for searching: remove diacritics and fold case. The
+  /// length of text is not changed.
+  static QString normalize(const QString &text);
+
+  /// Return true if all pages are indexed.
+  bool isComplete() const;
+
+  /// Start indexing all pages in the background.
+  void start();
+
+  /// Search needle starting from start_page. The result is sent by
+  /// searchFinished, directly if the index is complete and otherwise from
+  /// a worker thread.
+  void search(const QString &needle, int start_page, const bool forward);
+
+  /// Search needle in all pages in a worker thread. Matches are sent page by
+  /// page by pageMatches, followed by searchAllFinished.
+  void searchAllPages(const QString &needle);
+
+  /// Abort all running searches.
+  void cancelSearch() noexcept
+  {
+    ++search_id;
+    ++search_all_id;
+  }
+
+ signals:
+  /// Search finished. page is -1 if nothing was found.
+  void searchFinished(const int page, const QList<QRectF> &results);
+
+  /// Needle occurs count times on page. results is the outline of all
+  /// matches and snippet shows the text around the first match.
+  void pageMatches(const int page, const int count,
+                   const QList<QRectF> &results, const QString &snippet);
+
+  /// Search in all pages finished with the given total number of matches.
+  void searchAllFinished(const int hits);
+};
+
+#endif  // TEXTINDEX_H
@@ -44,6 +44,7 @@
 #include "src/drawing/texttool.h"
 #include "src/log.h"
 #include "src/media/mediaitem.h"
+#include "src/navigationbenchmark.h"
 #include "src/pdfmaster.h"
 #include "src/preferences.h"
 #include "src/slideview.h"
@@ -924,6 +925,7 @@ void SlideScene::navigationEvent(const int newslide, const int newpage,
 {
   debug_msg(DebugPageChange | DebugFunctionCalls,
             "scene" << this << "navigates to" << newpage << "as" << newscene);
+  NavigationBenchmark::record(NavigationBenchmark::SceneNavigated);
   pauseMedia();
   clearSelection();
   setFocusItem(nullptr);
@@ -940,6 +942,7 @@ void SlideScene::navigationEvent(const int newslide, const int newpage,
   pageItem->setOpacity(1.);
   pageItem->setRect(sceneRect());
   pageItem->trackNew();
+  pageItem->clearTiles();
   if ((!newscene || newscene == this) && page != newpage &&
       (slide_flags & ShowTransitions)) {
     SlideTransition transition =
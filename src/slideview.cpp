@@ -16,12 +16,14 @@
 #include "src/log.h"
 #include "src/media/mediaplayer.h"
 #include "src/media/mediaslider.h"
+#include "src/navigationbenchmark.h"
 #include "src/preferences.h"
 #include "src/rendering/pixcache.h"
+#include "src/rendering/renderstats.h"
 #include "src/slidescene.h"
 
 SlideView::SlideView(SlideScene *scene, const PixCache *cache, QWidget *parent)
-    : QGraphicsView(scene, parent)
+    : QGraphicsView(scene, parent), pixcache(cache)
 {
   setMouseTracking(true);
   setAttribute(Qt::WA_AcceptTouchEvents);
@@ -40,6 +42,14 @@ SlideView::SlideView(SlideScene *scene, const PixCache *cache, QWidget *parent)
           Qt::QueuedConnection);
   connect(cache, &PixCache::pageReady, this, &SlideView::pageReady,
           Qt::QueuedConnection);
+  connect(this, &SlideView::requestPreview, cache, &PixCache::requestPreview,
+          Qt::QueuedConnection);
+  connect(cache, &PixCache::previewReady, this, &SlideView::previewReady,
+          Qt::QueuedConnection);
+  connect(this, &SlideView::requestTile, cache, &PixCache::requestTile,
+          Qt::QueuedConnection);
+  connect(cache, &PixCache::tileReady, this, &SlideView::tileReady,
+          Qt::QueuedConnection);
   connect(this, &SlideView::resizeCache, cache, &PixCache::updateFrame,
           Qt::QueuedConnection);
   connect(this, &SlideView::getPixmapBlocking, cache, &PixCache::getPixmap,
@@ -56,6 +66,7 @@ QSize SlideView::sizeHint() const noexcept
 void SlideView::pageChanged(const int page, SlideScene *scene)
 {
   sliders.clear();
+  pending_tiles.clear();
   setScene(scene);
   const QSizeF &pageSize = scene->pageSize();
   if (pageSize.width() * height() > pageSize.height() * width())
@@ -71,6 +82,10 @@ void SlideView::pageChanged(const int page, SlideScene *scene)
   debug_msg(DebugPageChange, "Request page" << page << "by" << this << "from"
                                             << scene << "with size"
                                             << scene->pageSize() << size());
+  // The preview request is handled first by the cache. It only submits the
+  // preview to the RenderPool and does not delay rendering the page.
+  if (preferences()->preview_resolution > 0.)
+    emit requestPreview(page, resolution);
   emit requestPage(page, resolution);
 }
 
@@ -92,6 +107,9 @@ void SlideView::pageChangedBlocking(const int page, SlideScene *scene)
   debug_msg(DebugPageChange, "Request page blocking" << page << this);
   emit getPixmapBlocking(page, pixmap, resolution);
   scene->pageBackground()->addPixmap(pixmap);
+  RenderStats::instance().pageShown();
+  NavigationBenchmark::record(NavigationBenchmark::PageReady);
+  paint_pending = true;
   updateScene({sceneRect()});
 }
 
@@ -100,11 +118,32 @@ void SlideView::pageReady(const QPixmap pixmap, const int page)
   if (waitingForPage == page) {
     debug_msg(DebugPageChange, "page ready" << page << pixmap.size() << this);
     static_cast<SlideScene *>(scene())->pageBackground()->addPixmap(pixmap);
+    RenderStats::instance().pageShown();
+    NavigationBenchmark::record(NavigationBenchmark::PageReady);
+    paint_pending = true;
     waitingForPage = INT_MAX;
     updateScene({sceneRect()});
   }
 }
 
+void SlideView::paintEvent(QPaintEvent *event)
+{
+  QGraphicsView::paintEvent(event);
+  if (paint_pending) {
+    paint_pending = false;
+    NavigationBenchmark::record(NavigationBenchmark::PagePainted);
+  }
+}
+
+void SlideView::previewReady(const QPixmap pixmap, const int page)
+{
+  if (waitingForPage == page) {
+    debug_msg(DebugPageChange, "preview ready" << page << pixmap.size() << this);
+    static_cast<SlideScene *>(scene())->pageBackground()->addPreview(pixmap);
+    updateScene({sceneRect()});
+  }
+}
+
 void SlideView::resizeEvent(QResizeEvent *event)
 {
   if (event->size().isNull()) return;
@@ -278,12 +317,20 @@ bool SlideView::event(QEvent *event)
   return false;
 }
 
-void SlideView::requestScaledPage(const qreal zoom)
+void SlideView::requestScaledPage(const qreal zoom, const QRectF &region)
 {
   const SlideScene *sscene = dynamic_cast<SlideScene *>(scene());
   if (!sscene || zoom < 1e-6 || zoom > 1e6) return;
   const PixmapGraphicsItem *pageItem = sscene->pageBackground();
   if (!pageItem) return;
+  // Enlarged pages are rendered in tiles if the renderer supports it.
+  if (zoom > 1. && useTiles() &&
+      requestTiles(zoom * resolution,
+                   region.isNull()
+                       ? QGraphicsView::mapToScene(viewport()->rect())
+                             .boundingRect()
+                       : region))
+    return;
   const qreal target_width = zoom * resolution * sscene->pageSize().width();
   // Check whether an enlarged page is needed and not "in preparation" yet.
   if (waitingForPage == INT_MAX && !pageItem->hasWidth(target_width)) {
@@ -293,6 +340,57 @@ void SlideView::requestScaledPage(const qreal zoom)
   }
 }
 
+bool SlideView::useTiles() const noexcept
+{
+  return preferences()->tile_size > 0 && pixcache && pixcache->supportsTiles();
+}
+
+bool SlideView::requestTiles(const qreal tile_resolution,
+                             const QRectF &region)
+{
+  const SlideScene *sscene = dynamic_cast<SlideScene *>(scene());
+  const int tile_size = preferences()->tile_size;
+  if (!sscene || tile_size <= 0) return false;
+  const PixmapGraphicsItem *pageItem = sscene->pageBackground();
+  if (!pageItem) return false;
+  const QRectF page_rect = pageItem->boundingRect();
+  const QRectF visible = region & page_rect;
+  if (visible.isEmpty()) return true;
+  // Tile indices of visible area.
+  const qreal scale = tile_resolution / tile_size;
+  const int x0 = (visible.left() - page_rect.left()) * scale,
+            x1 = (visible.right() - page_rect.left()) * scale,
+            y0 = (visible.top() - page_rect.top()) * scale,
+            y1 = (visible.bottom() - page_rect.top()) * scale;
+  // Tiles would be removed from the page item before all are shown.
+  if ((x1 - x0 + 1) * (y1 - y0 + 1) > preferences()->max_tiles) return false;
+  for (int y = y0; y <= y1; ++y) {
+    for (int x = x0; x <= x1; ++x) {
+      const std::pair<qreal, QPoint> tile{tile_resolution, {x, y}};
+      if (pageItem->hasTile(tile_resolution, tile.second) ||
+          pending_tiles.contains(tile))
+        continue;
+      pending_tiles.append(tile);
+      emit requestTile(sscene->getPage(), tile_resolution, tile.second);
+    }
+  }
+  return true;
+}
+
+void SlideView::tileReady(const QPixmap pixmap, const int page,
+                          const qreal tile_resolution, const QPoint index)
+{
+  // Tiles which could not be rendered remain pending, such that they are not
+  // requested again on every paint event.
+  if (pixmap.isNull()) return;
+  pending_tiles.removeOne({tile_resolution, index});
+  SlideScene *sscene = dynamic_cast<SlideScene *>(scene());
+  if (!sscene || sscene->getPage() != page) return;
+  sscene->pageBackground()->addTile(pixmap, tile_resolution, index,
+                                    preferences()->tile_size);
+  updateScene({sceneRect()});
+}
+
 void SlideView::showMagnifier(QPainter *painter,
                               std::shared_ptr<PointingTool> tool) noexcept
 {
@@ -302,7 +400,16 @@ void SlideView::showMagnifier(QPainter *painter,
   painter->setPen(tool->color());
   painter->setBrush(Qt::NoBrush);
   const SlideScene *sscene = dynamic_cast<SlideScene *>(scene());
-  if (sscene) requestScaledPage(sscene->getZoom() * tool->scale());
+  if (sscene) {
+    // Only the parts of the page shown in the magnifier are required.
+    QRectF region;
+    for (const auto &pos : tool->pos())
+      region |= QRectF(pos.x() - tool->size() / tool->scale(),
+                       pos.y() - tool->size() / tool->scale(),
+                       2 * tool->size() / tool->scale(),
+                       2 * tool->size() / tool->scale());
+    requestScaledPage(sscene->getZoom() * tool->scale(), region);
+  }
   // Draw magnifier(s) at all positions of tool.
   for (const auto &pos : tool->pos()) {
     // calculate target rect: size of the magnifier
@@ -326,6 +433,13 @@ void SlideView::showMagnifier(QPainter *painter,
 
 void SlideView::drawForeground(QPainter *painter, const QRectF &rect)
 {
+  // Make sure that the visible tiles of a zoomed page are available, e.g.
+  // after the visible part of the page was moved. Only missing tiles which
+  // are not pending are requested.
+  const SlideScene *sscene = dynamic_cast<SlideScene *>(scene());
+  if (sscene && sscene->getZoom() > 1. && useTiles() &&
+      !requestTiles(sscene->getZoom() * resolution, rect))
+    requestScaledPage(sscene->getZoom(), rect);
   if (view_flags & ShowPointingTools) {
     painter->setRenderHint(QPainter::Antialiasing);
     const auto &current_tools = preferences()->current_tools;
@@ -5,6 +5,9 @@
 #define SLIDE_H
 
 #include <QGraphicsView>
+#include <QList>
+#include <QPoint>
+#include <QRectF>
 #include <cstring>
 #include <memory>
 
@@ -14,6 +17,7 @@
 #include "src/media/mediaslider.h"
 
 class QResizeEvent;
+class QPaintEvent;
 class QGestureEvent;
 class PointingTool;
 class PixCache;
@@ -54,6 +58,16 @@ class SlideView : public QGraphicsView
   /// Currently waiting for page: INT_MAX if not waiting for any page.
   int waitingForPage = INT_MAX;
 
+  /// A new page has been received but not painted yet.
+  bool paint_pending = false;
+
+  /// Cache providing pages for this view, not owned by this.
+  const PixCache *pixcache = nullptr;
+
+  /// Tiles which have been requested but not received yet or could not be
+  /// rendered, given by resolution and index. Cleared on page change.
+  QList<std::pair<qreal, QPoint>> pending_tiles;
+
   /// Show slide transitions, multimedia, etc. (all not implemented yet).
   ViewFlags view_flags = {ShowAll ^ MediaControls};
 
@@ -63,8 +77,18 @@ class SlideView : public QGraphicsView
   QMap<qint64, Tool::InputDevices> active_tablet_devices;
 
   /// Send request for rendering page with resolution increased by zoom relative
-  /// to normal view.
-  void requestScaledPage(const qreal zoom);
+  /// to normal view. If tiles are enabled, only the tiles intersecting region
+  /// (in scene coordinates) are requested. A null region is interpreted as
+  /// the visible part of the scene.
+  void requestScaledPage(const qreal zoom, const QRectF &region = QRectF());
+
+  /// Check whether enlarged pages should be rendered in tiles.
+  bool useTiles() const noexcept;
+
+  /// Request the tiles with given resolution which intersect region (in scene
+  /// coordinates) and which are neither available nor pending. Return false
+  /// if region contains too many tiles, in this case nothing is requested.
+  bool requestTiles(const qreal tile_resolution, const QRectF &region);
 
  protected:
   /// Handle gesture events. Currently, this handles swipe and pinch gestures
@@ -101,9 +125,10 @@ class SlideView : public QGraphicsView
   /// page with adjusted resolution.
   void setZoom(const qreal zoom, const bool render = true)
   {
-    if (render) requestScaledPage(zoom);
     const qreal rel_scale = zoom / transform().m11() * resolution;
     scale(rel_scale, rel_scale);
+    // Request after scaling, such that the visible region is known.
+    if (render) requestScaledPage(zoom);
   }
 
  protected slots:
@@ -128,6 +153,13 @@ class SlideView : public QGraphicsView
   /// Inform this that page is ready in pixcache.
   void pageReady(const QPixmap pixmap, const int page);
 
+  /// Show preview while waiting for page.
+  void previewReady(const QPixmap pixmap, const int page);
+
+  /// Add tile of enlarged page to the page background.
+  void tileReady(const QPixmap pixmap, const int page, const qreal resolution,
+                 const QPoint index);
+
   /// Draw magnifier to painter. tool should have BasicTool Magnifier, but this
   /// is not checked.
   void showMagnifier(QPainter *painter,
@@ -147,6 +179,9 @@ class SlideView : public QGraphicsView
   /// Draw pointing tools in foreground.
   void drawForeground(QPainter *painter, const QRectF &rect) override;
 
+  /// Paint event: additionally report the first paint of a new page.
+  void paintEvent(QPaintEvent *event) override;
+
   /// Add a slider for a video item
   void addMediaSlider(const std::shared_ptr<MediaItem> media);
 
@@ -169,6 +204,12 @@ class SlideView : public QGraphicsView
   void requestPage(const int page, const qreal resolution,
                    const bool cache_page = true);
 
+  /// Request a preview, which is shown until the page is ready.
+  void requestPreview(const int page, const qreal resolution);
+
+  /// Request a tile of an enlarged page.
+  void requestTile(const int page, const qreal resolution, const QPoint index);
+
   /// Send key event to Master.
   void sendKeyEvent(QKeyEvent *event);
 